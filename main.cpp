@@ -2,17 +2,44 @@
 //
 
 #include <iostream>
+#include <csignal>
+#include <thread>
+
+#include <pthread.h>
 
 int main() {
     try {
+        // SIGTERM/SIGINT are taken synchronously by one thread, so the drain runs in
+        // ordinary code rather than a signal handler. Blocking them here, before any
+        // server thread exists, makes every thread inherit the mask.
+        sigset_t stop_signals;
+        sigemptyset(&stop_signals);
+        sigaddset(&stop_signals, SIGTERM);
+        sigaddset(&stop_signals, SIGINT);
+        pthread_sigmask(SIG_BLOCK, &stop_signals, nullptr);
+
         Config config;
         Server server(config);
 
+        std::thread signal_thread([&] {
+            int signal_number = 0;
+            sigwait(&stop_signals, &signal_number);
+            server.stop();
+        });
+
         std::cout << "Starting file server..." << std::endl;
         std::cout << "Web interface: http://localhost:" << config.port << std::endl;
         std::cout << "API base URL: http://localhost:" << config.port << "/api/" << std::endl;
 
-        server.start();
+        try {
+            server.start();
+        }
+        catch (...) {
+            pthread_kill(signal_thread.native_handle(), SIGTERM);
+            signal_thread.join();
+            throw;
+        }
+        signal_thread.join();
     }
     catch (const std::exception& e) 
     {
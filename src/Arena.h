@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+// Monotonic arena for everything one batch of requests allocates. Allocation bumps a
+// pointer through a block the arena keeps for its whole life, spilling to the heap
+// only past that; reset() forgets the lot at once.
+//
+// A connection reuses its batch and arena, so once it has warmed up, framing the
+// requests and building and serializing the responses make no heap calls for batches
+// that fit (AllocationTest counts them). What still goes to the heap:
+//  - per batch, the task handed to the handler pool and the result posted back to
+//    the loop (both std::function, too big for its inline buffer), and now and then
+//    a node of the pool's queue or the backend's output queue;
+//  - a new batch, when the handler pool still holds the last one, and arena blocks
+//    past the first for a batch that outgrows it;
+//  - whatever handlers build themselves: header values they own (ETag,
+//    Last-Modified, Content-Type, Content-Disposition), paths and decoded query
+//    parameters, shared bodies (FileBody, streamed bodies, cached assets) and
+//    jsoncpp documents;
+//  - the request log line, when logging is on.
+//
+// Code that has no allocator to hand (HttpResponse bodies, say) allocates from
+// current(): the arena a Scope has installed on this thread, or the ordinary heap.
+class Arena
+{
+public:
+    explicit Arena(size_t block_size = 16 * 1024)
+        : block(std::make_unique<std::byte[]>(block_size)), resource(block.get(), block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    std::pmr::memory_resource* get() { return &resource; }
+
+    // Only once nothing allocated from the arena is still alive.
+    void reset() { resource.release(); }
+
+    static std::pmr::memory_resource* current() {
+        return current_arena != nullptr ? current_arena->get() : std::pmr::new_delete_resource();
+    }
+
+    class Scope
+    {
+    public:
+        explicit Scope(Arena& arena) : previous(current_arena) { current_arena = &arena; }
+        ~Scope() { current_arena = previous; }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Arena* previous;
+    };
+
+private:
+    std::unique_ptr<std::byte[]> block;
+    std::pmr::monotonic_buffer_resource resource;
+
+    static inline thread_local Arena* current_arena = nullptr;
+};
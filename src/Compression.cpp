@@ -0,0 +1,141 @@
+#include "Compression.h"
+#include "HttpHeaders.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    // Instances kept per thread between responses; more than this are freed.
+    constexpr size_t MaxIdleDeflaters = 4;
+
+    thread_local std::vector<std::unique_ptr<Deflater>> idle_deflaters;
+
+    std::string_view trimWhitespace(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Whether a "q=..." parameter list allows the coding; anything unparseable does.
+    bool accepted(std::string_view params) {
+        while (!params.empty()) {
+            size_t semicolon = params.find(';');
+            std::string_view param = trimWhitespace(params.substr(0, semicolon));
+            params = semicolon == std::string_view::npos ? std::string_view() : params.substr(semicolon + 1);
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                std::string_view value = param.substr(2);
+                // q is at most three decimals; only all zeros rules the coding out
+                return value.find_first_not_of("0.") != std::string_view::npos;
+            }
+        }
+        return true;
+    }
+}
+
+bool acceptsCoding(std::string_view accept_encoding, ContentCoding coding) {
+    std::string_view wanted = codingName(coding);
+    bool listed = false;
+    bool any = false;
+
+    while (!accept_encoding.empty()) {
+        size_t comma = accept_encoding.find(',');
+        std::string_view item = trimWhitespace(accept_encoding.substr(0, comma));
+        accept_encoding = comma == std::string_view::npos ? std::string_view() : accept_encoding.substr(comma + 1);
+
+        size_t semicolon = item.find(';');
+        std::string_view name = trimWhitespace(item.substr(0, semicolon));
+        bool ok = semicolon == std::string_view::npos || accepted(item.substr(semicolon + 1));
+
+        if (headerNameEquals(name, wanted) || (coding == ContentCoding::Gzip && headerNameEquals(name, "x-gzip"))) {
+            if (!ok) {
+                return false;
+            }
+            listed = true;
+        }
+        else if (name == "*") {
+            any = ok;
+        }
+    }
+    // "*" covers only the codings the header doesn't name
+    return listed || any;
+}
+
+ContentCoding negotiateCoding(std::string_view accept_encoding) {
+    if (acceptsCoding(accept_encoding, ContentCoding::Gzip)) {
+        return ContentCoding::Gzip;
+    }
+    if (acceptsCoding(accept_encoding, ContentCoding::Deflate)) {
+        return ContentCoding::Deflate;
+    }
+    return ContentCoding::Identity;
+}
+
+std::string_view codingName(ContentCoding coding) {
+    switch (coding) {
+    case ContentCoding::Gzip: return "gzip";
+    case ContentCoding::Deflate: return "deflate";
+    case ContentCoding::Zstd: return "zstd";
+    case ContentCoding::Identity: break;
+    }
+    return {};
+}
+
+bool isCompressible(std::string_view mime_type) {
+    mime_type = trimWhitespace(mime_type.substr(0, mime_type.find(';')));
+    return mime_type.starts_with("text/") || mime_type.ends_with("+json") || mime_type.ends_with("+xml") ||
+        mime_type == "application/json" || mime_type == "application/x-ndjson" ||
+        mime_type == "application/javascript" || mime_type == "application/xml" || mime_type == "image/svg+xml";
+}
+
+Deflater::Deflater(ContentCoding coding_, int level_) : coding(coding_), level(level_) {
+    if (coding == ContentCoding::Zstd || coding == ContentCoding::Identity) {
+        throw std::runtime_error("Deflater only produces gzip and deflate");
+    }
+    // 16 more window bits asks zlib for a gzip wrapper; plain is the zlib format
+    // that HTTP calls deflate
+    int window_bits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+    if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw std::runtime_error("deflateInit2 failed");
+    }
+}
+
+Deflater::~Deflater() {
+    deflateEnd(&stream);
+}
+
+Deflater::Handle Deflater::acquire(ContentCoding coding, int level) {
+    for (auto it = idle_deflaters.begin(); it != idle_deflaters.end(); ++it) {
+        if ((*it)->coding == coding && (*it)->level == level) {
+            Handle handle((*it).release());
+            idle_deflaters.erase(it);
+            return handle;
+        }
+    }
+    return Handle(new Deflater(coding, level));
+}
+
+void Deflater::Release::operator()(Deflater* deflater) const {
+    // Back on the list of whichever thread finished with it
+    std::unique_ptr<Deflater> owned(deflater);
+    if (idle_deflaters.size() < MaxIdleDeflaters && deflateReset(&owned->stream) == Z_OK) {
+        idle_deflaters.push_back(std::move(owned));
+    }
+}
+
+size_t Deflater::step(unsigned char* out, size_t capacity, bool finish, bool& done) {
+    stream.next_out = out;
+    stream.avail_out = static_cast<uInt>(capacity);
+    int result = deflate(&stream, finish ? Z_FINISH : Z_SYNC_FLUSH);
+    if (result == Z_STREAM_ERROR) {
+        throw std::runtime_error("deflate failed");
+    }
+
+    // Done once the input is in and the flush fitted: Z_STREAM_END for a finish,
+    // room left over for a sync flush
+    done = stream.avail_in == 0 && (finish ? result == Z_STREAM_END : stream.avail_out != 0);
+    return capacity - stream.avail_out;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+#include <zlib.h>
+
+// Zstd is only ever served from files compressed ahead of time; Deflater makes the
+// other two.
+enum class ContentCoding : uint8_t { Identity, Gzip, Deflate, Zstd };
+
+// Whether an Accept-Encoding header takes the coding, by name or through "*".
+// A q of 0 rules a coding out.
+bool acceptsCoding(std::string_view accept_encoding, ContentCoding coding);
+
+// The coding to compress with on the fly: gzip if the client takes it, then
+// deflate, else identity.
+ContentCoding negotiateCoding(std::string_view accept_encoding);
+
+// Content-Encoding token ("gzip", "deflate", "zstd"); empty for identity.
+std::string_view codingName(ContentCoding coding);
+
+// Text-like types that shrink well. Images, audio, video and archives are already
+// compressed and are left alone.
+bool isCompressible(std::string_view mime_type);
+
+// zlib deflate state, set up once and reset between messages. Released instances go
+// back to a small per-thread free list, so compressing a response reuses one of the
+// thread's contexts instead of allocating zlib's tables every time.
+class Deflater
+{
+public:
+    struct Release {
+        void operator()(Deflater* deflater) const;
+    };
+    using Handle = std::unique_ptr<Deflater, Release>;
+
+    static Handle acquire(ContentCoding coding, int level);
+
+    ~Deflater();
+
+    Deflater(const Deflater&) = delete;
+    Deflater& operator=(const Deflater&) = delete;
+
+    // Appends the compressed form of data to out, a contiguous byte container.
+    // finish ends the message; otherwise what was given so far is flushed to a byte
+    // boundary, so the client can decode it without waiting for more.
+    template <typename Buffer>
+    void compress(const void* data, size_t size, bool finish, Buffer& out) {
+        stream.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+        stream.avail_in = static_cast<uInt>(size);
+
+        bool done = false;
+        while (!done) {
+            size_t used = out.size();
+            out.resize(used + std::max<size_t>(deflateBound(&stream, stream.avail_in), 256));
+            size_t written = step(reinterpret_cast<unsigned char*>(out.data()) + used, out.size() - used, finish, done);
+            out.resize(used + written);
+        }
+    }
+
+private:
+    z_stream stream{};
+    ContentCoding coding;
+    int level;
+
+    Deflater(ContentCoding coding, int level);
+
+    size_t step(unsigned char* out, size_t capacity, bool finish, bool& done);
+};
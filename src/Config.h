@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <string>
+
 struct Config 
 {
     int port = 8080;
@@ -8,4 +11,25 @@ struct Config
     bool enable_cors = true;
     bool enable_logging = true;
     std::string log_file = "server.log";
+    int worker_threads = 0;       // Event loops, one per core; 0 uses hardware_concurrency()
+    int listen_backlog = 4096;
+    bool reuse_port = true;       // One SO_REUSEPORT listener per worker instead of a shared one
+    int defer_accept_secs = 0;    // TCP_DEFER_ACCEPT: wake accept only once data has arrived
+    std::string io_backend = "auto";  // "epoll", "io_uring", or "auto" (io_uring, falling back to epoll)
+    int handler_threads = 0;              // Request handler pool; 0 uses 2 x hardware_concurrency()
+    size_t handler_queue_depth = 1024;    // Requests beyond this get an immediate 503
+    int handler_queue_timeout_ms = 2000;  // Queued longer than this: 503 instead of running
+    int handler_retry_after_secs = 1;
+    size_t max_request_size = 16 * 1024 * 1024;  // Header block plus body, in bytes
+    int keep_alive_timeout_secs = 5;      // Idle connections are closed after this; 0 disables keep-alive
+    int header_timeout_secs = 10;         // From a request's first byte to the end of its headers; 0 disables
+    int body_timeout_secs = 30;           // Longest gap between body reads; 0 disables
+    int write_timeout_secs = 30;          // Longest the client may stall a response; 0 disables
+    int max_keep_alive_requests = 100;    // Requests answered on one connection before it is closed
+    size_t max_pipeline_depth = 16;       // Pipelined requests handled (and answered) as one batch
+    size_t zerocopy_min_bytes = 1024 * 1024;  // Shared bodies this large go out with MSG_ZEROCOPY; 0 disables
+    bool enable_compression = true;       // gzip/deflate for text-like responses the client accepts
+    size_t compression_min_bytes = 1024;  // Smaller bodies go out as they are
+    int compression_level = 6;            // zlib level, 1 (fastest) to 9 (smallest)
+    int shutdown_grace_secs = 30;         // stop(): time in-flight responses get before being cut off
 };
@@ -3,8 +3,11 @@
 class FileManager {
 private:
     std::string root_directory;
-    std::mutex file_mutex;
+    std::mutex file_mutex;  // Serializes writes and deletes; reads never take it
     Logger& logger;
+    std::atomic<uint64_t> generation{ 0 };  // Bumped by every write and delete made here
+    fs::path canonical_root;
+    int root_fd = -1;       // Paths from requests are opened relative to this
 
 public:
     struct FileInfo {
@@ -28,66 +31,107 @@ public:
         }
     };
 
+    // A directory found to lie under the root, with the stat() taken while checking.
+    struct Directory {
+        std::string full_path;
+        struct stat st;
+    };
+
     FileManager(const std::string& root, Logger& log) : root_directory(root), logger(log) {
         fs::create_directories(root);
+        canonical_root = fs::canonical(fs::absolute(root));
+        root_fd = open(root.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (root_fd < 0) {
+            throw std::runtime_error("Cannot open root directory " + root + ": " + std::strerror(errno));
+        }
         logger.info("FileManager initialized with root: " + root);
     }
 
-    std::vector<FileInfo> listDirectory(const std::string& relative_path = "") {
-        std::lock_guard<std::mutex> lock(file_mutex);
-        std::vector<FileInfo> files;
+    ~FileManager() {
+        close(root_fd);
+    }
 
-        std::string full_path = root_directory + "/" + relative_path;
-        if (!isPathSafe(full_path)) {
-            logger.warning("Unsafe path access attempt: " + relative_path);
-            return files;
+    // Checks the path and stats the directory in one go: an openat2() and an fstat().
+    std::optional<Directory> findDirectory(const std::string& relative_path) {
+        int fd = openBeneath(relative_path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EXDEV) {
+                logger.warning("Unsafe path access attempt: " + relative_path);
+            }
+            return std::nullopt;
         }
 
-        try {
-            for (const auto& entry : fs::directory_iterator(full_path)) {
-                FileInfo info;
-                info.name = entry.path().filename().string();
-                info.path = relative_path + (relative_path.empty() ? "" : "/") + info.name;
-                info.is_directory = entry.is_directory();
-                info.size = entry.is_directory() ? 0 : entry.file_size();
-                info.mime_type = getMimeType(info.name);
-
-                auto time = fs::last_write_time(entry);
-                auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    time - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-                std::time_t tt = std::chrono::system_clock::to_time_t(sctp);
-                std::ostringstream oss;
-                oss << std::put_time(std::localtime(&tt), "%Y-%m-%d %H:%M:%S");
-                info.modified = oss.str();
-
-                files.push_back(info);
-            }
+        Directory directory{ root_directory + "/" + relative_path, {} };
+        bool found = fstat(fd, &directory.st) == 0;
+        close(fd);
+        if (!found) {
+            return std::nullopt;
         }
-        catch (const std::exception& e) {
-            logger.error("Error listing directory: " + std::string(e.what()));
+        return directory;
+    }
+
+    // Starts walking a directory found by findDirectory(); false if it can't be listed.
+    bool openDirectory(const Directory& directory, fs::directory_iterator& it) {
+        std::error_code error;
+        it = fs::directory_iterator(directory.full_path, error);
+        if (error) {
+            logger.error("Error listing directory: " + error.message());
+            return false;
         }
+        return true;
+    }
 
-        return files;
+    // Weak ETag for a directory's listing, from the stat() findDirectory() took: its
+    // mtime moves when entries are added, removed or renamed, and the generation
+    // when a file is rewritten through this server. Files edited in place by other
+    // processes go unnoticed until the directory itself changes.
+    std::string directoryVersion(const Directory& directory, std::string_view format) const {
+        std::string suffix = std::to_string(generation.load(std::memory_order_relaxed));
+        suffix += '-';
+        suffix += format;
+        return "W/" + fileETag(directory.st, suffix);
     }
 
-    std::vector<uint8_t> readFile(const std::string& relative_path) {
-        std::lock_guard<std::mutex> lock(file_mutex);
-        std::string full_path = root_directory + "/" + relative_path;
+    FileInfo fileInfo(const fs::directory_entry& entry, const std::string& relative_path) const {
+        FileInfo info;
+        info.name = entry.path().filename().string();
+        info.path = relative_path + (relative_path.empty() ? "" : "/") + info.name;
+        info.is_directory = entry.is_directory();
+        info.size = entry.is_directory() ? 0 : entry.file_size();
+        info.mime_type = getMimeType(info.name);
+
+        auto time = fs::last_write_time(entry);
+        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            time - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+        std::time_t tt = std::chrono::system_clock::to_time_t(sctp);
+        std::ostringstream oss;
+        oss << std::put_time(std::localtime(&tt), "%Y-%m-%d %H:%M:%S");
+        info.modified = oss.str();
+        return info;
+    }
 
-        if (!isPathSafe(full_path)) {
+    // Opens a file for streaming; the I/O backend reads it while sending. The path
+    // check is the open itself, so validating a download costs an open and an fstat().
+    std::shared_ptr<FileBody> openFile(const std::string& relative_path) {
+        int fd = openBeneath(relative_path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0 && errno == EXDEV) {
             logger.warning("Unsafe file read attempt: " + relative_path);
-            return {};
+            return nullptr;
         }
 
-        std::ifstream file(full_path, std::ios::binary);
-        if (!file) {
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            if (fd >= 0) {
+                close(fd);
+            }
             logger.warning("File not found: " + relative_path);
-            return {};
+            return nullptr;
         }
 
-        logger.info("File downloaded: " + relative_path);
-        return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>());
+        auto body = std::make_shared<FileBody>(fd, 0, static_cast<uint64_t>(st.st_size));
+        body->modified = st.st_mtim.tv_sec;
+        body->etag = fileETag(st);
+        return body;
     }
 
     bool writeFile(const std::string& relative_path, const std::vector<uint8_t>& data) {
@@ -113,6 +157,7 @@ public:
 
         if (success) {
             logger.info("File uploaded: " + relative_path + " (" + std::to_string(data.size()) + " bytes)");
+            generation.fetch_add(1, std::memory_order_relaxed);
         }
         else {
             logger.error("Failed to write file: " + relative_path);
@@ -134,6 +179,7 @@ public:
 
         if (success) {
             logger.info("File deleted: " + relative_path);
+            generation.fetch_add(1, std::memory_order_relaxed);
         }
         else {
             logger.warning("Failed to delete file: " + relative_path);
@@ -142,41 +188,77 @@ public:
         return success;
     }
 
-    Json::Value getStats() {
-        std::lock_guard<std::mutex> lock(file_mutex);
+    // Each subdirectory is walked as its own subtask so idle pool threads can steal
+    // parts of a large tree instead of one handler walking it end to end.
+    Json::Value getStats(ThreadPool& pool) {
         Json::Value stats;
 
-        uint64_t total_size = 0;
-        int file_count = 0;
-        int folder_count = 0;
-
-        try {
-            for (const auto& entry : fs::recursive_directory_iterator(root_directory)) {
-                if (entry.is_directory()) {
-                    folder_count++;
-                }
-                else {
-                    file_count++;
-                    total_size += entry.file_size();
+        std::atomic<uint64_t> total_size{ 0 };
+        std::atomic<int> file_count{ 0 };
+        std::atomic<int> folder_count{ 0 };
+
+        TaskGroup group(pool);
+        std::function<void(const fs::path&)> walk = [&](const fs::path& dir) {
+            try {
+                uint64_t dir_size = 0;
+                int dir_files = 0;
+                for (const auto& entry : fs::directory_iterator(dir)) {
+                    if (entry.is_directory()) {
+                        folder_count++;
+                        if (!entry.is_symlink()) {
+                            group.spawn([&walk, path = entry.path()] { walk(path); });
+                        }
+                    }
+                    else {
+                        dir_files++;
+                        dir_size += entry.file_size();
+                    }
                 }
+                file_count += dir_files;
+                total_size += dir_size;
             }
-        }
-        catch (const std::exception& e) {
-            logger.error("Error calculating stats: " + std::string(e.what()));
-        }
+            catch (const std::exception& e) {
+                logger.error("Error calculating stats: " + std::string(e.what()));
+            }
+        };
+
+        walk(root_directory);
+        group.wait();
 
-        stats["total_files"] = file_count;
-        stats["total_folders"] = folder_count;
-        stats["total_size"] = static_cast<Json::UInt64>(total_size);
-        stats["total_size_formatted"] = formatFileSize(total_size);
+        stats["total_files"] = file_count.load();
+        stats["total_folders"] = folder_count.load();
+        stats["total_size"] = static_cast<Json::UInt64>(total_size.load());
+        stats["total_size_formatted"] = formatFileSize(total_size.load());
 
         return stats;
     }
 
 private:
+    // Opens a path under the root in one call: openat2() with RESOLVE_BENEATH fails
+    // with EXDEV for anything that would leave it, through ".." or a symlink alike.
+    // Kernels before 5.6 lack openat2() and get the canonical-path check instead.
+    int openBeneath(const std::string& relative_path, int flags) const {
+        size_t start = relative_path.find_first_not_of('/');
+        std::string relative = start == std::string::npos ? "." : relative_path.substr(start);
+
+        open_how how{};
+        how.flags = static_cast<uint64_t>(flags);
+        how.resolve = RESOLVE_BENEATH;
+        int fd = static_cast<int>(syscall(SYS_openat2, root_fd, relative.c_str(), &how, sizeof(how)));
+        if (fd >= 0 || errno != ENOSYS) {
+            return fd;
+        }
+
+        std::string full_path = root_directory + "/" + relative;
+        if (!isPathSafe(full_path)) {
+            errno = EXDEV;
+            return -1;
+        }
+        return open(full_path.c_str(), flags);
+    }
+
     bool isPathSafe(const std::string& path) const {
         try {
-            fs::path canonical_root = fs::canonical(fs::absolute(root_directory));
             fs::path canonical_path = fs::canonical(fs::absolute(path));
 
             auto rel = fs::relative(canonical_path, canonical_root);
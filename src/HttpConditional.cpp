@@ -0,0 +1,98 @@
+#include "HttpConditional.h"
+#include "HttpDate.h"
+#include "HttpRequest.h"
+
+#include <charconv>
+#include <cstdint>
+
+namespace {
+    void appendHex(std::string& out, uint64_t value) {
+        char digits[16];
+        out.append(digits, std::to_chars(digits, digits + sizeof(digits), value, 16).ptr);
+    }
+
+    std::string_view opaqueTag(std::string_view etag) {
+        if (etag.starts_with("W/")) {
+            etag.remove_prefix(2);
+        }
+        return etag;
+    }
+}
+
+std::string fileETag(const struct stat& st, std::string_view suffix) {
+    std::string etag = "\"";
+    appendHex(etag, static_cast<uint64_t>(st.st_ino));
+    etag += '-';
+    appendHex(etag, static_cast<uint64_t>(st.st_size));
+    etag += '-';
+    appendHex(etag, static_cast<uint64_t>(st.st_mtim.tv_sec) * 1000000000u + static_cast<uint64_t>(st.st_mtim.tv_nsec));
+    if (!suffix.empty()) {
+        etag += '-';
+        etag += suffix;
+    }
+    etag += '"';
+    return etag;
+}
+
+std::string etagVariant(std::string_view etag, std::string_view suffix) {
+    if (etag.size() < 2 || etag.back() != '"') {
+        return std::string(etag);
+    }
+    std::string variant(etag.substr(0, etag.size() - 1));
+    variant += '-';
+    variant += suffix;
+    variant += '"';
+    return variant;
+}
+
+bool etagListMatches(std::string_view list, std::string_view etag) {
+    etag = opaqueTag(etag);
+    while (!list.empty()) {
+        size_t start = list.find_first_not_of(" \t,");
+        if (start == std::string_view::npos) {
+            break;
+        }
+        list.remove_prefix(start);
+        if (list.front() == '*') {
+            return true;
+        }
+
+        // Tags are quoted and may hold commas, so walk to the closing quote
+        size_t open = list.starts_with("W/") ? 2 : 0;
+        size_t close = open < list.size() && list[open] == '"' ? list.find('"', open + 1) : std::string_view::npos;
+        if (close == std::string_view::npos) {
+            break;
+        }
+        if (list.substr(open, close + 1 - open) == etag) {
+            return true;
+        }
+        list.remove_prefix(close + 1);
+    }
+    return false;
+}
+
+bool isNotModified(const HttpRequest& request, std::string_view etag, std::time_t modified) {
+    if (request.method != "GET" && request.method != "HEAD") {
+        return false;
+    }
+
+    std::string_view if_none_match = request.header(HeaderId::IfNoneMatch);
+    if (!if_none_match.empty()) {
+        return etagListMatches(if_none_match, etag);
+    }
+
+    std::string_view if_modified_since = request.header(HeaderId::IfModifiedSince);
+    if (!if_modified_since.empty()) {
+        auto since = parseHttpDate(if_modified_since);
+        return since && modified <= *since;
+    }
+    return false;
+}
+
+std::string_view revalidatedETag(const HttpRequest& request, std::string_view etag, std::string_view recoded) {
+    std::string_view if_none_match = request.header(HeaderId::IfNoneMatch);
+    if (!recoded.empty() && !etagListMatches(if_none_match, etag) && etagListMatches(if_none_match, recoded)) {
+        return recoded;
+    }
+    return etag;
+}
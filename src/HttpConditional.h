@@ -0,0 +1,32 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <string_view>
+
+#include <sys/stat.h>
+
+class HttpRequest;
+
+// Strong entity tag for a file as it is now, from its inode, size and modification
+// time: replacing or rewriting the file changes it. suffix tells apart different
+// representations of the same file, such as a compressed variant.
+std::string fileETag(const struct stat& st, std::string_view suffix = {});
+
+// The tag of another representation of what etag names, such as a compressed
+// copy: suffix goes inside the quotes, and a weak tag stays weak.
+std::string etagVariant(std::string_view etag, std::string_view suffix);
+
+// Whether an If-None-Match style list names etag; "*" names any. Uses the weak
+// comparison of RFC 9110 section 8.8.3.2, so W/ prefixes are ignored.
+bool etagListMatches(std::string_view list, std::string_view etag);
+
+// RFC 9110 section 13.2.2 for a GET or HEAD: If-None-Match decides when present,
+// otherwise If-Modified-Since against modified. True means answer 304.
+bool isNotModified(const HttpRequest& request, std::string_view etag, std::time_t modified);
+
+// The tag to validate a request against when its response may be compressed on the
+// way out and tagged recoded then (empty if it won't be): recoded if If-None-Match
+// names it and not etag, so a client revalidating its compressed copy gets a 304
+// too; etag otherwise.
+std::string_view revalidatedETag(const HttpRequest& request, std::string_view etag, std::string_view recoded);
@@ -0,0 +1,33 @@
+#include "HttpDate.h"
+
+std::string formatHttpDate(std::time_t time) {
+    std::tm parts{};
+    gmtime_r(&time, &parts);
+    char text[32];
+    size_t length = std::strftime(text, sizeof(text), "%a, %d %b %Y %H:%M:%S GMT", &parts);
+    return std::string(text, length);
+}
+
+std::optional<std::time_t> parseHttpDate(std::string_view text) {
+    // strptime needs a terminated string; anything longer isn't a date
+    char buffer[40];
+    if (text.size() >= sizeof(buffer)) {
+        return std::nullopt;
+    }
+    text.copy(buffer, text.size());
+    buffer[text.size()] = '\0';
+
+    static constexpr const char* formats[] = {
+        "%a, %d %b %Y %H:%M:%S GMT",    // IMF-fixdate
+        "%A, %d-%b-%y %H:%M:%S GMT",    // RFC 850
+        "%a %b %e %H:%M:%S %Y",         // asctime
+    };
+    for (const char* format : formats) {
+        std::tm parts{};
+        const char* end = strptime(buffer, format, &parts);
+        if (end != nullptr && *end == '\0') {
+            return timegm(&parts);
+        }
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <ctime>
+#include <optional>
+#include <string>
+#include <string_view>
+
+// IMF-fixdate, the form every HTTP date is sent in: "Sun, 06 Nov 1994 08:49:37 GMT".
+std::string formatHttpDate(std::time_t time);
+
+// Accepts IMF-fixdate and the two obsolete forms RFC 9110 section 5.6.7 still asks
+// recipients to read (RFC 850 and asctime). nullopt for anything else.
+std::optional<std::time_t> parseHttpDate(std::string_view text);
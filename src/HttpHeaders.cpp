@@ -0,0 +1,72 @@
+#include "HttpHeaders.h"
+
+#include <cctype>
+
+namespace {
+    // Indexed by HeaderId
+    constexpr std::string_view header_names[] = {
+        "",
+        "Accept",
+        "Accept-Encoding",
+        "Accept-Ranges",
+        "Access-Control-Allow-Headers",
+        "Access-Control-Allow-Methods",
+        "Access-Control-Allow-Origin",
+        "Cache-Control",
+        "Connection",
+        "Content-Disposition",
+        "Content-Encoding",
+        "Content-Length",
+        "Content-Range",
+        "Content-Type",
+        "Date",
+        "ETag",
+        "Host",
+        "If-Match",
+        "If-Modified-Since",
+        "If-None-Match",
+        "If-Range",
+        "If-Unmodified-Since",
+        "Keep-Alive",
+        "Last-Modified",
+        "Range",
+        "Retry-After",
+        "Server",
+        "Transfer-Encoding",
+        "User-Agent",
+        "Vary",
+        "X-Content-Type-Options",
+        "X-Frame-Options",
+        "X-XSS-Protection",
+    };
+
+    constexpr size_t header_count = sizeof(header_names) / sizeof(header_names[0]);
+    static_assert(header_count == static_cast<size_t>(HeaderId::XXssProtection) + 1, "header_names out of step with HeaderId");
+}
+
+bool headerNameEquals(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HeaderId headerId(std::string_view name) {
+    // Most candidates are ruled out by length and first letter before any real compare
+    for (size_t i = 1; i < header_count; ++i) {
+        std::string_view known = header_names[i];
+        if (known.size() == name.size() && (known[0] | 0x20) == (name[0] | 0x20) && headerNameEquals(known, name)) {
+            return static_cast<HeaderId>(i);
+        }
+    }
+    return HeaderId::Other;
+}
+
+std::string_view headerName(HeaderId id) {
+    return header_names[static_cast<size_t>(id)];
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Header names the server reads or writes, interned so that lookups compare an id
+// instead of a string. Anything else is Other and matched by name.
+enum class HeaderId : uint8_t
+{
+    Other,
+    Accept,
+    AcceptEncoding,
+    AcceptRanges,
+    AccessControlAllowHeaders,
+    AccessControlAllowMethods,
+    AccessControlAllowOrigin,
+    CacheControl,
+    Connection,
+    ContentDisposition,
+    ContentEncoding,
+    ContentLength,
+    ContentRange,
+    ContentType,
+    Date,
+    ETag,
+    Host,
+    IfMatch,
+    IfModifiedSince,
+    IfNoneMatch,
+    IfRange,
+    IfUnmodifiedSince,
+    KeepAlive,
+    LastModified,
+    Range,
+    RetryAfter,
+    Server,
+    TransferEncoding,
+    UserAgent,
+    Vary,
+    XContentTypeOptions,
+    XFrameOptions,
+    XXssProtection,
+};
+
+// Case-insensitive; Other for names that aren't interned.
+HeaderId headerId(std::string_view name);
+
+// Canonical spelling of an interned name.
+std::string_view headerName(HeaderId id);
+
+bool headerNameEquals(std::string_view a, std::string_view b);
+
+// A response header value: a string literal, kept as a view with no allocation, or
+// a string the value owns. Only pass arrays that are literals - anything else must
+// be converted to std::string first, or be borrowed().
+class HeaderValue
+{
+public:
+    HeaderValue() = default;
+    HeaderValue(std::string value) : owned(std::move(value)), is_owned(true) {}
+
+    template <size_t N>
+    HeaderValue(const char (&literal)[N]) : text(literal, N - 1) {}
+
+    // A view of text that outlives the response, such as its batch's arena.
+    static HeaderValue borrowed(std::string_view value) {
+        HeaderValue result;
+        result.text = value;
+        return result;
+    }
+
+    std::string_view view() const { return is_owned ? std::string_view(owned) : text; }
+
+private:
+    std::string owned;
+    std::string_view text;
+    bool is_owned = false;
+};
+
+// Flat header list, in the order headers were added. The first InlineCapacity entries
+// live inside the object, so typical messages never touch the heap; past that the list
+// moves to a vector. Names are views: either the interned spelling, or bytes that
+// outlive the list (the request buffer, a literal).
+template <typename Value>
+class HeaderList
+{
+public:
+    struct Entry {
+        HeaderId id = HeaderId::Other;
+        std::string_view name;
+        Value value;
+    };
+
+    static constexpr size_t InlineCapacity = 16;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const Entry* begin() const { return entries(); }
+    const Entry* end() const { return entries() + count; }
+
+    void reserve(size_t capacity) {
+        if (capacity > InlineCapacity && overflow.empty()) {
+            overflow.reserve(capacity);
+        }
+    }
+
+    void clear() {
+        count = 0;
+        overflow.clear();
+    }
+
+    // Keeps any earlier header of the same name (requests may repeat them).
+    void add(HeaderId id, std::string_view name, Value value) {
+        if (count < InlineCapacity && overflow.empty()) {
+            inline_entries[count] = Entry{ id, name, std::move(value) };
+        }
+        else {
+            if (overflow.empty()) {
+                overflow.reserve(InlineCapacity * 2);
+                std::move(inline_entries.begin(), inline_entries.end(), std::back_inserter(overflow));
+            }
+            overflow.push_back(Entry{ id, name, std::move(value) });
+        }
+        ++count;
+    }
+
+    // Replaces the first header of that name, or adds it.
+    void set(HeaderId id, Value value) {
+        if (Entry* entry = find(id)) {
+            entry->value = std::move(value);
+        }
+        else {
+            add(id, headerName(id), std::move(value));
+        }
+    }
+
+    void set(std::string_view name, Value value) {
+        HeaderId id = headerId(name);
+        if (id != HeaderId::Other) {
+            set(id, std::move(value));
+        }
+        else if (Entry* entry = find(name)) {
+            entry->value = std::move(value);
+        }
+        else {
+            add(id, name, std::move(value));
+        }
+    }
+
+    bool contains(HeaderId id) const { return find(id) != nullptr; }
+    bool contains(std::string_view name) const { return find(name) != nullptr; }
+
+    // Value of the first header with this name, or null.
+    const Value* get(HeaderId id) const {
+        const Entry* entry = find(id);
+        return entry != nullptr ? &entry->value : nullptr;
+    }
+
+    const Value* get(std::string_view name) const {
+        const Entry* entry = find(name);
+        return entry != nullptr ? &entry->value : nullptr;
+    }
+
+private:
+    std::array<Entry, InlineCapacity> inline_entries{};
+    std::vector<Entry> overflow;
+    size_t count = 0;
+
+    Entry* entries() { return overflow.empty() ? inline_entries.data() : overflow.data(); }
+    const Entry* entries() const { return overflow.empty() ? inline_entries.data() : overflow.data(); }
+
+    Entry* find(HeaderId id) {
+        return const_cast<Entry*>(std::as_const(*this).find(id));
+    }
+
+    const Entry* find(HeaderId id) const {
+        for (const Entry& entry : *this) {
+            if (entry.id == id) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+
+    Entry* find(std::string_view name) {
+        return const_cast<Entry*>(std::as_const(*this).find(name));
+    }
+
+    const Entry* find(std::string_view name) const {
+        HeaderId id = headerId(name);
+        if (id != HeaderId::Other) {
+            return find(id);
+        }
+        for (const Entry& entry : *this) {
+            if (entry.id == HeaderId::Other && headerNameEquals(entry.name, name)) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+};
@@ -0,0 +1,92 @@
+#include "HttpRange.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace {
+    std::string_view trimWhitespace(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Digits only: from_chars alone would take a sign.
+    bool parseNumber(std::string_view text, uint64_t& value) {
+        if (text.empty() || text.front() < '0' || text.front() > '9') {
+            return false;
+        }
+        auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+}
+
+std::optional<std::vector<ByteRange>> parseRange(std::string_view header, uint64_t size) {
+    header = trimWhitespace(header);
+    if (header.size() < 6 || header.substr(0, 6) != "bytes=") {
+        return std::nullopt;
+    }
+    std::string_view rest = header.substr(6);
+
+    std::vector<ByteRange> ranges;
+    size_t specs = 0;
+    while (!rest.empty()) {
+        size_t comma = rest.find(',');
+        std::string_view spec = trimWhitespace(rest.substr(0, comma));
+        rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+        if (spec.empty()) {
+            continue;   // Empty list elements are allowed
+        }
+        if (++specs > MaxByteRanges) {
+            return std::nullopt;
+        }
+
+        size_t dash = spec.find('-');
+        if (dash == std::string_view::npos) {
+            return std::nullopt;
+        }
+        std::string_view first_text = spec.substr(0, dash);
+        std::string_view last_text = spec.substr(dash + 1);
+
+        if (first_text.empty()) {
+            // Suffix: the last n bytes
+            uint64_t suffix = 0;
+            if (!parseNumber(last_text, suffix)) {
+                return std::nullopt;
+            }
+            if (suffix > 0 && size > 0) {
+                suffix = std::min(suffix, size);
+                ranges.push_back({ size - suffix, suffix });
+            }
+            continue;
+        }
+
+        uint64_t first = 0;
+        uint64_t last = UINT64_MAX;
+        if (!parseNumber(first_text, first) || (!last_text.empty() && !parseNumber(last_text, last)) || last < first) {
+            return std::nullopt;
+        }
+        if (first < size) {
+            ranges.push_back({ first, std::min(last, size - 1) - first + 1 });
+        }
+    }
+    if (specs == 0) {
+        return std::nullopt;
+    }
+
+    // Overlapping ranges would make the response larger than the file for nothing
+    std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) { return a.first < b.first; });
+    std::vector<ByteRange> merged;
+    for (const ByteRange& range : ranges) {
+        if (!merged.empty() && range.first <= merged.back().last() + 1) {
+            merged.back().length = std::max(merged.back().last(), range.last()) - merged.back().first + 1;
+        }
+        else {
+            merged.push_back(range);
+        }
+    }
+    return merged;
+}
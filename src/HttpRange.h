@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct ByteRange {
+    uint64_t first;
+    uint64_t length;
+
+    uint64_t last() const { return first + length - 1; }
+};
+
+// More ranges than this in one request and the Range header is ignored.
+constexpr size_t MaxByteRanges = 16;
+
+// Reads a Range header against a representation of size bytes (RFC 9110 section
+// 14.2). nullopt means ignore the header and send everything: a unit other than
+// bytes, bad syntax, or too many ranges. Otherwise the satisfiable ranges in file
+// order, with overlapping and adjacent ones merged; empty if none can be satisfied.
+std::optional<std::vector<ByteRange>> parseRange(std::string_view header, uint64_t size);
@@ -0,0 +1,241 @@
+#include "HttpRequest.h"
+#include "HttpScan.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+
+namespace {
+    // Methods and header names are made of RFC 9110 tchars.
+    bool isToken(std::string_view text) {
+        return !text.empty() && HttpScan::findNonToken(text.data(), text.data() + text.size()) == text.data() + text.size();
+    }
+
+    bool hasControl(std::string_view text) {
+        return HttpScan::findControl(text.data(), text.data() + text.size()) != text.data() + text.size();
+    }
+
+    constexpr std::array<int8_t, 256> hex_values = [] {
+        std::array<int8_t, 256> values{};
+        values.fill(-1);
+        for (int i = 0; i < 10; ++i) {
+            values['0' + i] = static_cast<int8_t>(i);
+        }
+        for (int i = 0; i < 6; ++i) {
+            values['a' + i] = static_cast<int8_t>(10 + i);
+            values['A' + i] = static_cast<int8_t>(10 + i);
+        }
+        return values;
+    }();
+
+    std::string_view trimWhitespace(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+}
+
+std::string_view HttpRequest::header(HeaderId id) const {
+    const std::string_view* value = headers.get(id);
+    return value != nullptr ? *value : std::string_view();
+}
+
+std::string_view HttpRequest::header(std::string_view name) const {
+    const std::string_view* value = headers.get(name);
+    return value != nullptr ? *value : std::string_view();
+}
+
+bool HttpRequest::wantsKeepAlive() const {
+    std::string connection(header(HeaderId::Connection));
+    std::transform(connection.begin(), connection.end(), connection.begin(), ::tolower);
+
+    if (connection.find("close") != std::string::npos) {
+        return false;
+    }
+    return version == "HTTP/1.1" || connection.find("keep-alive") != std::string::npos;
+}
+
+std::optional<std::string_view> QueryView::raw(std::string_view name) const {
+    std::string_view rest = query;
+    while (!rest.empty()) {
+        size_t amp = rest.find('&');
+        std::string_view pair = rest.substr(0, amp);
+        rest = amp == std::string_view::npos ? std::string_view() : rest.substr(amp + 1);
+
+        size_t equals = pair.find('=');
+        if (equals != std::string_view::npos && pair.substr(0, equals) == name) {
+            return pair.substr(equals + 1);
+        }
+    }
+    return std::nullopt;
+}
+
+size_t percentDecode(char* data, size_t size, bool plus_is_space) {
+    size_t in = 0;
+    // Nothing moves until the first escape
+    while (in < size && data[in] != '%' && !(plus_is_space && data[in] == '+')) {
+        ++in;
+    }
+
+    auto hex = [data](size_t at) { return hex_values[static_cast<unsigned char>(data[at])]; };
+
+    size_t out = in;
+    while (in < size) {
+        char c = data[in];
+        if (c == '%' && in + 2 < size && hex(in + 1) >= 0 && hex(in + 2) >= 0) {
+            data[out++] = static_cast<char>(hex(in + 1) * 16 + hex(in + 2));
+            in += 3;
+        }
+        else {
+            data[out++] = plus_is_space && c == '+' ? ' ' : c;
+            ++in;
+        }
+    }
+    return out;
+}
+
+HttpRequestParser::Status HttpRequestParser::parse(std::string_view data) {
+    while (state == State::RequestLine || state == State::HeaderLine) {
+        size_t newline = data.find('\n', scanned);
+        if (newline == std::string_view::npos) {
+            scanned = data.size();
+            return data.size() > max_size ? Status::TooLarge : Status::NeedHeaders;
+        }
+        if (newline >= max_size) {
+            return Status::TooLarge;
+        }
+
+        // Lines end in CRLF; a bare LF is accepted too
+        size_t line_end = newline > line_start && data[newline - 1] == '\r' ? newline - 1 : newline;
+        std::string_view line = data.substr(line_start, line_end - line_start);
+        size_t offset = line_start;
+        scanned = line_start = newline + 1;
+
+        if (state == State::RequestLine) {
+            // Stray blank lines ahead of a request are skipped (RFC 9112 section 2.2)
+            if (!line.empty()) {
+                if (!parseRequestLine(line, offset)) {
+                    return Status::Invalid;
+                }
+                state = State::HeaderLine;
+            }
+        }
+        else if (!line.empty()) {
+            if (!parseHeaderLine(line, offset)) {
+                return Status::Invalid;
+            }
+        }
+        else {
+            header_size = line_start;
+            if (content_length > max_size || header_size + content_length > max_size) {
+                return Status::TooLarge;
+            }
+            state = State::Body;
+        }
+    }
+
+    if (state == State::Body) {
+        if (data.size() < header_size + content_length) {
+            return Status::NeedBody;
+        }
+        state = State::Done;
+    }
+    return Status::Complete;
+}
+
+bool HttpRequestParser::parseRequestLine(std::string_view line, size_t offset) {
+    size_t first_space = line.find(' ');
+    if (first_space == std::string_view::npos) {
+        return false;
+    }
+    size_t second_space = line.find(' ', first_space + 1);
+    if (second_space == std::string_view::npos || second_space == first_space + 1 ||
+            line.find(' ', second_space + 1) != std::string_view::npos) {
+        return false;
+    }
+
+    std::string_view version_text = line.substr(second_space + 1);
+    if (!isToken(line.substr(0, first_space)) || hasControl(line) || version_text.size() != 8 ||
+            !version_text.starts_with("HTTP/1.") || !std::isdigit(static_cast<unsigned char>(version_text[7]))) {
+        return false;
+    }
+
+    method = { offset, first_space };
+    target = { offset + first_space + 1, second_space - first_space - 1 };
+    version = { offset + second_space + 1, version_text.size() };
+    return true;
+}
+
+bool HttpRequestParser::parseHeaderLine(std::string_view line, size_t offset) {
+    // The name runs up to the colon: no whitespace before it, and no obsolete line
+    // folding. The value may hold anything but control characters.
+    const char* name_end = HttpScan::findNonToken(line.data(), line.data() + line.size());
+    size_t colon = static_cast<size_t>(name_end - line.data());
+    if (colon == 0 || colon == line.size() || *name_end != ':') {
+        return false;
+    }
+    std::string_view name = line.substr(0, colon);
+    std::string_view value = trimWhitespace(line.substr(colon + 1));
+    if (hasControl(value)) {
+        return false;
+    }
+
+    HeaderId id = headerId(name);
+    if (id == HeaderId::ContentLength) {
+        size_t length = 0;
+        auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), length);
+        if (value.empty() || error != std::errc() || end != value.data() + value.size() ||
+                (has_content_length && length != content_length)) {
+            return false;
+        }
+        has_content_length = true;
+        content_length = length;
+    }
+    else if (id == HeaderId::TransferEncoding) {
+        // Request bodies are only ever sized by Content-Length; refusing the rest
+        // leaves no room for a proxy to disagree about where a request ends
+        return false;
+    }
+
+    size_t value_offset = static_cast<size_t>(value.data() - line.data());
+    header_spans.push_back({ id, { offset, colon }, { offset + value_offset, value.size() } });
+    return true;
+}
+
+void HttpRequestParser::build(HttpRequest& request, std::string_view data) const {
+    auto view = [data](Span span) { return data.substr(span.offset, span.length); };
+
+    request.method = view(method);
+    request.version = view(version);
+
+    std::string_view full_path = view(target);
+    size_t query_pos = full_path.find('?');
+    request.path = full_path.substr(0, query_pos);
+    request.query_string = query_pos != std::string_view::npos ? full_path.substr(query_pos + 1) : std::string_view();
+
+    request.headers.clear();
+    request.headers.reserve(header_spans.size());
+    for (const HeaderSpan& header : header_spans) {
+        request.headers.add(header.id, view(header.name), view(header.value));
+    }
+    request.body = data.substr(header_size, content_length);
+}
+
+void HttpRequestParser::reset() {
+    state = State::RequestLine;
+    scanned = 0;
+    line_start = 0;
+    method = {};
+    target = {};
+    version = {};
+    header_spans.clear();
+    has_content_length = false;
+    content_length = 0;
+    header_size = 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "HttpHeaders.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Decodes %xx escapes (and '+' as a space, when plus_is_space) in place - decoding
+// only ever shrinks the text - and returns the decoded length. A '%' without two hex
+// digits after it is kept as it is.
+size_t percentDecode(char* data, size_t size, bool plus_is_space);
+
+// Lazy view of a query string: nothing is split or decoded until a parameter is asked
+// for, and then only that one.
+class QueryView
+{
+public:
+    explicit QueryView(std::string_view query) : query(query) {}
+
+    // Still encoded: the value of the first parameter with this name.
+    std::optional<std::string_view> raw(std::string_view name) const;
+
+    // The parameter as T: std::string (decoded) or an integer. Empty when it is missing
+    // or doesn't convert.
+    template <typename T>
+    std::optional<T> get(std::string_view name) const {
+        std::optional<std::string_view> value = raw(name);
+        if (!value) {
+            return std::nullopt;
+        }
+        if constexpr (std::is_same_v<T, std::string>) {
+            std::string decoded(*value);
+            decoded.resize(percentDecode(decoded.data(), decoded.size(), true));
+            return decoded;
+        }
+        else {
+            static_assert(std::is_integral_v<T>, "QueryView::get<T>: T must be std::string or an integer type");
+            char digits[32];
+            if (value->size() > sizeof(digits)) {
+                return std::nullopt;
+            }
+            std::copy(value->begin(), value->end(), digits);
+            size_t length = percentDecode(digits, value->size(), true);
+
+            T number{};
+            auto [end, error] = std::from_chars(digits, digits + length, number);
+            if (error != std::errc() || end != digits + length) {
+                return std::nullopt;
+            }
+            return number;
+        }
+    }
+
+private:
+    std::string_view query;
+};
+
+// A parsed request. Every field but client_ip is a view into the bytes the request
+// arrived in, which whoever owns the request (the connection's current batch) keeps
+// alive and unchanged for as long as the request lives.
+class HttpRequest
+{
+public:
+    std::string_view method;
+    std::string_view path;
+    std::string_view version;
+    std::string_view query_string;
+    HeaderList<std::string_view> headers;
+    std::string_view body;
+    std::string client_ip;
+
+    // Value of the first header with this name (compared case-insensitively), or empty.
+    std::string_view header(HeaderId id) const;
+    std::string_view header(std::string_view name) const;
+
+    // HTTP/1.1 keeps the connection open unless told otherwise; HTTP/1.0 only when asked.
+    bool wantsKeepAlive() const;
+
+    QueryView queryParams() const { return QueryView(query_string); }
+
+    // Shorthand for queryParams().get<T>(name).
+    template <typename T>
+    std::optional<T> query(std::string_view name) const {
+        return queryParams().get<T>(name);
+    }
+};
+
+// Incremental request parser. parse() is handed everything buffered so far for the
+// current request, starting at its first byte, and picks up scanning where the last
+// call stopped, so a request arriving over many reads is only scanned once. Nothing
+// is copied: build() fills in views into the same bytes.
+class HttpRequestParser
+{
+public:
+    enum class Status { NeedHeaders, NeedBody, Complete, TooLarge, Invalid };
+
+    explicit HttpRequestParser(size_t max_request_size) : max_size(max_request_size) {}
+
+    Status parse(std::string_view data);
+
+    // Once parse() returned Complete: the request's length, and the request itself as
+    // views into data (which must hold the same bytes parse() saw).
+    size_t requestSize() const { return header_size + content_length; }
+    void build(HttpRequest& request, std::string_view data) const;
+
+    // Ready for the next request.
+    void reset();
+
+private:
+    enum class State { RequestLine, HeaderLine, Body, Done };
+
+    // Offsets from the start of the request; the buffer may move between calls.
+    struct Span {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    size_t max_size;
+    State state = State::RequestLine;
+    size_t scanned = 0;         // Next byte to look at
+    size_t line_start = 0;
+    Span method;
+    Span target;
+    Span version;
+    struct HeaderSpan {
+        HeaderId id;
+        Span name;
+        Span value;
+    };
+    std::vector<HeaderSpan> header_spans;  // Kept across requests for its capacity
+    bool has_content_length = false;
+    size_t content_length = 0;
+    size_t header_size = 0;
+
+    bool parseRequestLine(std::string_view line, size_t offset);
+    bool parseHeaderLine(std::string_view line, size_t offset);
+};
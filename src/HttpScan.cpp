@@ -0,0 +1,187 @@
+#include "HttpScan.h"
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HTTP_SCAN_X86 1
+#endif
+
+namespace {
+    constexpr bool isTokenByte(unsigned char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+            (c != 0 && std::string_view("!#$%&'*+-.^_`|~").find(static_cast<char>(c)) != std::string_view::npos);
+    }
+
+    constexpr bool isControlByte(unsigned char c) {
+        return (c < 0x20 && c != '\t') || c == 0x7f;
+    }
+
+    constexpr std::array<bool, 256> token_table = [] {
+        std::array<bool, 256> table{};
+        for (int c = 0; c < 256; ++c) {
+            table[c] = isTokenByte(static_cast<unsigned char>(c));
+        }
+        return table;
+    }();
+
+    const char* findNonTokenScalar(const char* begin, const char* end) {
+        while (begin != end && token_table[static_cast<unsigned char>(*begin)]) {
+            ++begin;
+        }
+        return begin;
+    }
+
+    const char* findControlScalar(const char* begin, const char* end) {
+        while (begin != end && !isControlByte(static_cast<unsigned char>(*begin))) {
+            ++begin;
+        }
+        return begin;
+    }
+
+#ifdef HTTP_SCAN_X86
+    // PCMPESTRI takes at most 8 ranges, so this is a superset of the non-token bytes:
+    // '|' and '~' share the last range and are let through by the scalar check.
+    alignas(16) constexpr char non_token_ranges[16] = {
+        '\x00', ' ', '"', '"', '(', ')', ',', ',', '/', '/', ':', '@', '[', ']', '{', '\xff'
+    };
+    alignas(16) constexpr char control_ranges[16] = { '\x00', '\x08', '\x0a', '\x1f', '\x7f', '\x7f' };
+
+    __attribute__((target("sse4.2")))
+    const char* findNonTokenSse42(const char* begin, const char* end) {
+        const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(non_token_ranges));
+        while (end - begin >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            int index = _mm_cmpestri(ranges, 16, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+            if (index == 16) {
+                begin += 16;
+                continue;
+            }
+            begin += index;
+            if (!token_table[static_cast<unsigned char>(*begin)]) {
+                return begin;
+            }
+            ++begin;
+        }
+        return findNonTokenScalar(begin, end);
+    }
+
+    __attribute__((target("sse4.2")))
+    const char* findControlSse42(const char* begin, const char* end) {
+        const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(control_ranges));
+        while (end - begin >= 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+            int index = _mm_cmpestri(ranges, 6, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+            if (index != 16) {
+                return begin + index;
+            }
+            begin += 16;
+        }
+        return findControlScalar(begin, end);
+    }
+
+    // Exact set membership by nibble lookup: a byte is a non-token byte when
+    // low_nibble_bits[c & 15] & high_nibble_bits[c >> 4] is non-zero. Bit 6 stands for
+    // the rows that are wholly outside the token set (controls and bytes >= 0x80);
+    // rows 0x20-0x7f get a bit each.
+    struct NibbleTables {
+        alignas(16) uint8_t low[16];
+        alignas(16) uint8_t high[16];
+    };
+
+    constexpr NibbleTables non_token_nibbles = [] {
+        NibbleTables tables{};
+        for (int high = 0; high < 16; ++high) {
+            tables.high[high] = high >= 2 && high <= 7 ? static_cast<uint8_t>(1 << (high - 2)) : 0x40;
+        }
+        for (int low = 0; low < 16; ++low) {
+            uint8_t bits = 0x40;
+            for (int high = 2; high <= 7; ++high) {
+                if (!token_table[high * 16 + low]) {
+                    bits |= static_cast<uint8_t>(1 << (high - 2));
+                }
+            }
+            tables.low[low] = bits;
+        }
+        return tables;
+    }();
+
+    __attribute__((target("avx2")))
+    const char* findNonTokenAvx2(const char* begin, const char* end) {
+        const __m256i low_table = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(non_token_nibbles.low)));
+        const __m256i high_table = _mm256_broadcastsi128_si256(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(non_token_nibbles.high)));
+        const __m256i nibble_mask = _mm256_set1_epi8(0x0f);
+
+        while (end - begin >= 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            __m256i low = _mm256_shuffle_epi8(low_table, _mm256_and_si256(chunk, nibble_mask));
+            __m256i high = _mm256_shuffle_epi8(high_table, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), nibble_mask));
+            __m256i token = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), _mm256_setzero_si256());
+            uint32_t hits = ~static_cast<uint32_t>(_mm256_movemask_epi8(token));
+            if (hits != 0) {
+                return begin + __builtin_ctz(hits);
+            }
+            begin += 32;
+        }
+        return findNonTokenSse42(begin, end);
+    }
+
+    __attribute__((target("avx2")))
+    const char* findControlAvx2(const char* begin, const char* end) {
+        const __m256i last_control = _mm256_set1_epi8(0x1f);
+        const __m256i tab = _mm256_set1_epi8('\t');
+        const __m256i del = _mm256_set1_epi8(0x7f);
+
+        while (end - begin >= 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+            __m256i below_space = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, last_control), chunk);
+            __m256i control = _mm256_or_si256(
+                _mm256_andnot_si256(_mm256_cmpeq_epi8(chunk, tab), below_space),
+                _mm256_cmpeq_epi8(chunk, del));
+            uint32_t hits = static_cast<uint32_t>(_mm256_movemask_epi8(control));
+            if (hits != 0) {
+                return begin + __builtin_ctz(hits);
+            }
+            begin += 32;
+        }
+        return findControlSse42(begin, end);
+    }
+#endif
+
+    struct Kernels {
+        const char* name;
+        const char* (*find_non_token)(const char*, const char*);
+        const char* (*find_control)(const char*, const char*);
+    };
+
+    Kernels selectKernels() {
+#ifdef HTTP_SCAN_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) {
+            return { "avx2", findNonTokenAvx2, findControlAvx2 };
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return { "sse4.2", findNonTokenSse42, findControlSse42 };
+        }
+#endif
+        return { "scalar", findNonTokenScalar, findControlScalar };
+    }
+
+    const Kernels kernels = selectKernels();
+}
+
+const char* HttpScan::findNonToken(const char* begin, const char* end) {
+    return kernels.find_non_token(begin, end);
+}
+
+const char* HttpScan::findControl(const char* begin, const char* end) {
+    return kernels.find_control(begin, end);
+}
+
+const char* HttpScan::kernelName() {
+    return kernels.name;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Byte-class scans behind HttpRequestParser. Each returns the first byte in
+// [begin, end) that belongs to the class, or end. The implementation is picked once
+// at startup for the CPU we run on: AVX2 or SSE4.2 on x86, otherwise portable scalar
+// code. Another architecture (NEON on the Pi) only needs to add its own Kernels entry
+// in HttpScan.cpp.
+//
+// Line ends are found with memchr, which the C library already vectorises.
+namespace HttpScan
+{
+    // Anything that can't appear in a method or header name (RFC 9110 tchar),
+    // such as the ':' that ends a header name.
+    const char* findNonToken(const char* begin, const char* end);
+
+    // Control characters other than tab, which can't appear in a target or a header
+    // value.
+    const char* findControl(const char* begin, const char* end);
+
+    // The variant in use ("avx2", "sse4.2" or "scalar"), for the startup log.
+    const char* kernelName();
+}
@@ -31,6 +31,14 @@ public:
     void info(const std::string& msg) { log("INFO", msg); }
     void error(const std::string& msg) { log("ERROR", msg); }
     void warning(const std::string& msg) { log("WARN", msg); }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        if (log_file.is_open()) {
+            log_file.flush();
+        }
+        std::cout.flush();
+    }
 };
 
 /*
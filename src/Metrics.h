@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <json/json.h>
+
+// Process-wide counters, updated lock-free from any thread and served by /api/metrics.
+struct Metrics 
+{
+    std::atomic<uint64_t> requests_total{ 0 };
+    std::atomic<uint64_t> requests_rejected{ 0 };    // Handler queue full
+    std::atomic<uint64_t> requests_expired{ 0 };     // Waited past the queue deadline
+
+    std::atomic<uint64_t> connections_accepted{ 0 };
+    std::atomic<uint64_t> connections_reused{ 0 };   // Served more than one request
+    std::atomic<uint64_t> keep_alive_requests{ 0 };  // Requests that skipped a new handshake
+    std::atomic<uint64_t> idle_timeouts{ 0 };
+    std::atomic<uint64_t> header_timeouts{ 0 };     // Header block not complete in time
+    std::atomic<uint64_t> body_timeouts{ 0 };       // Body stalled
+    std::atomic<uint64_t> write_timeouts{ 0 };      // Client stopped reading the response
+
+    std::atomic<uint64_t> queue_waits{ 0 };
+    std::atomic<uint64_t> queue_wait_us_total{ 0 };
+    std::atomic<uint64_t> queue_wait_us_max{ 0 };
+
+    std::atomic<uint64_t> compressed_responses{ 0 };
+    std::atomic<uint64_t> compression_bytes_in{ 0 };
+    std::atomic<uint64_t> compression_bytes_out{ 0 };
+    std::atomic<uint64_t> compression_us_total{ 0 };  // CPU time spent deflating
+
+    void recordQueueWait(uint64_t wait_us) {
+        queue_waits.fetch_add(1, std::memory_order_relaxed);
+        queue_wait_us_total.fetch_add(wait_us, std::memory_order_relaxed);
+
+        uint64_t seen = queue_wait_us_max.load(std::memory_order_relaxed);
+        while (wait_us > seen && !queue_wait_us_max.compare_exchange_weak(seen, wait_us, std::memory_order_relaxed)) {
+        }
+    }
+
+    void recordCompression(uint64_t bytes_in, uint64_t bytes_out, uint64_t elapsed_us) {
+        compression_bytes_in.fetch_add(bytes_in, std::memory_order_relaxed);
+        compression_bytes_out.fetch_add(bytes_out, std::memory_order_relaxed);
+        compression_us_total.fetch_add(elapsed_us, std::memory_order_relaxed);
+    }
+
+    Json::Value toJson() const {
+        Json::Value json;
+        uint64_t waits = queue_waits.load(std::memory_order_relaxed);
+
+        json["requests_total"] = static_cast<Json::UInt64>(requests_total.load(std::memory_order_relaxed));
+        json["requests_rejected"] = static_cast<Json::UInt64>(requests_rejected.load(std::memory_order_relaxed));
+        json["requests_expired"] = static_cast<Json::UInt64>(requests_expired.load(std::memory_order_relaxed));
+        json["connections_accepted"] = static_cast<Json::UInt64>(connections_accepted.load(std::memory_order_relaxed));
+        json["connections_reused"] = static_cast<Json::UInt64>(connections_reused.load(std::memory_order_relaxed));
+        json["keep_alive_requests"] = static_cast<Json::UInt64>(keep_alive_requests.load(std::memory_order_relaxed));
+        json["idle_timeouts"] = static_cast<Json::UInt64>(idle_timeouts.load(std::memory_order_relaxed));
+        json["header_timeouts"] = static_cast<Json::UInt64>(header_timeouts.load(std::memory_order_relaxed));
+        json["body_timeouts"] = static_cast<Json::UInt64>(body_timeouts.load(std::memory_order_relaxed));
+        json["write_timeouts"] = static_cast<Json::UInt64>(write_timeouts.load(std::memory_order_relaxed));
+        json["queue_wait_us_avg"] = static_cast<Json::UInt64>(
+            waits ? queue_wait_us_total.load(std::memory_order_relaxed) / waits : 0);
+        json["queue_wait_us_max"] = static_cast<Json::UInt64>(queue_wait_us_max.load(std::memory_order_relaxed));
+        json["compressed_responses"] = static_cast<Json::UInt64>(compressed_responses.load(std::memory_order_relaxed));
+        json["compression_bytes_in"] = static_cast<Json::UInt64>(compression_bytes_in.load(std::memory_order_relaxed));
+        json["compression_bytes_out"] = static_cast<Json::UInt64>(compression_bytes_out.load(std::memory_order_relaxed));
+        json["compression_us_total"] = static_cast<Json::UInt64>(compression_us_total.load(std::memory_order_relaxed));
+        return json;
+    }
+};
@@ -0,0 +1,635 @@
+#include "EpollBackend.h"
+#include "../Socket/SocketType.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+class EpollBackend::Listener : public EventHandler
+{
+public:
+    Listener(int fd, IoAcceptor* acceptor, EpollBackend& backend)
+            : m_fd(fd)
+            , m_acceptor(acceptor)
+            , m_backend(backend)
+    {
+    }
+
+    int fd() const { return m_fd; }
+
+    void onEvents(uint32_t) override;
+
+private:
+    int m_fd;
+    IoAcceptor* m_acceptor;
+    EpollBackend& m_backend;
+};
+
+class EpollBackend::Socket : public EventHandler
+{
+public:
+    struct Output
+    {
+        const char* data;       // nullptr for file output
+        int file_fd;
+        uint64_t offset;
+        uint64_t length;
+        std::shared_ptr<const void> owner;  // Set for zero-copy output
+        bool copy_file = false;             // sendfile() refused this file; pread() it instead
+    };
+
+    int fd;
+    IoChannel* channel;
+    std::deque<Output> pending;
+    bool closed = false;
+    bool flush_queued = false;
+    bool waiting_writable = false;  // Last write hit EAGAIN; EPOLLOUT resumes it
+
+    // MSG_ZEROCOPY sends from the oldest one the kernel hasn't reported done on, and
+    // the memory they use. The kernel numbers them 0, 1, 2... per socket.
+    struct ZeroCopySend
+    {
+        std::shared_ptr<const void> owner;
+        bool done = false;
+    };
+    bool zerocopy_enabled = false;  // SO_ZEROCOPY is on
+    bool zerocopy_off = false;      // Refused, or the kernel copies anyway (loopback)
+    uint32_t zerocopy_first = 0;    // Sequence number of zerocopy_sends.front()
+    std::deque<ZeroCopySend> zerocopy_sends;
+    std::chrono::steady_clock::time_point lingering_since;
+
+    Socket(int socket_fd, IoChannel* ch, EpollBackend& backend)
+            : fd(socket_fd)
+            , channel(ch)
+            , m_backend(backend)
+    {
+    }
+
+    void onEvents(uint32_t events) override
+    {
+        if (zerocopy_enabled && (events & EPOLLERR))
+        {
+            reapZeroCopy();
+            if (closed)
+            {
+                if (!zeroCopyPending())
+                {
+                    m_backend.endLinger(this);
+                }
+                return;
+            }
+        }
+        if (!closed && (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)))
+        {
+            receive();
+        }
+        if (!closed && (events & EPOLLERR))
+        {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+            // Zero-copy notifications raise EPOLLERR too; only a socket error is fatal
+            if (error != 0 || !zerocopy_enabled)
+            {
+                channel->onError(error);
+                return;
+            }
+        }
+        if (events & EPOLLOUT)
+        {
+            waiting_writable = false;
+        }
+        if (!closed && (events & EPOLLOUT) && !pending.empty())
+        {
+            if (flush() && !closed)
+            {
+                channel->onSendComplete();
+            }
+        }
+    }
+
+    // Writes as much pending output as the socket takes. True once everything is out.
+    // Consecutive memory items go out together in one sendmsg(); files go out with
+    // sendfile(), straight from the page cache, and zero-copy items on their own.
+    bool flush()
+    {
+        while (!pending.empty())
+        {
+            ssize_t sent;
+
+            if (pending.front().owner && canZeroCopy())
+            {
+                sent = sendZeroCopyChunk(pending.front());
+            }
+            else if (pending.front().data != nullptr)
+            {
+                iovec iov[MaxGather];
+                size_t count = 0;
+                auto it = pending.begin();
+                for (; it != pending.end() && it->data != nullptr && count < MaxGather; ++it)
+                {
+                    if (count > 0 && it->owner && canZeroCopy())
+                    {
+                        break;
+                    }
+                    iov[count].iov_base = const_cast<char*>(it->data);
+                    iov[count].iov_len = it->length;
+                    ++count;
+                }
+
+                msghdr msg{};
+                msg.msg_iov = iov;
+                msg.msg_iovlen = count;
+                // A head followed by a file or zero-copy body: hold it back to share a segment
+                int flags = MSG_NOSIGNAL | (it != pending.end() ? MSG_MORE : 0);
+                sent = ::sendmsg(fd, &msg, flags);
+            }
+            else
+            {
+                sent = sendFileChunk(pending.front());
+                if (sent == 0)
+                {
+                    fail(EIO);  // The file shrank under us
+                    return false;
+                }
+            }
+
+            if (sent < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                {
+                    waiting_writable = true;
+                    return false;  // Resumed by the next EPOLLOUT edge
+                }
+                fail(errno);
+                return false;
+            }
+
+            consume(static_cast<uint64_t>(sent));
+            channel->onSendProgress();
+        }
+        return true;
+    }
+
+    bool zeroCopyPending() const { return !zerocopy_sends.empty(); }
+
+private:
+    static constexpr size_t MaxGather = 64;
+    static constexpr size_t MaxFileChunk = 1 << 30;
+
+    EpollBackend& m_backend;
+
+    // SO_ZEROCOPY is switched on the first time a socket has zero-copy output.
+    bool canZeroCopy()
+    {
+        if (!zerocopy_enabled && !zerocopy_off)
+        {
+            int one = 1;
+            zerocopy_enabled = setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) == 0;
+            zerocopy_off = !zerocopy_enabled;
+        }
+        return !zerocopy_off;
+    }
+
+    ssize_t sendZeroCopyChunk(const Output& out)
+    {
+        ssize_t sent = ::send(fd, out.data, out.length, MSG_NOSIGNAL | MSG_ZEROCOPY);
+        if (sent >= 0)
+        {
+            zerocopy_sends.push_back({ out.owner });
+        }
+        else if (errno == ENOBUFS)
+        {
+            // Out of option memory for pinning pages: copy this time
+            sent = ::send(fd, out.data, out.length, MSG_NOSIGNAL);
+        }
+        return sent;
+    }
+
+    // Marks off the completions queued on the error queue and lets go of memory up to
+    // the oldest send still out. The kernel reports ranges of sends, mostly in order.
+    void reapZeroCopy()
+    {
+        while (true)
+        {
+            char control[CMSG_SPACE(sizeof(sock_extended_err)) * 4];
+            msghdr msg{};
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            if (::recvmsg(fd, &msg, MSG_ERRQUEUE) < 0)
+            {
+                break;  // EAGAIN once the queue is empty
+            }
+
+            for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm))
+            {
+                bool is_error = (cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) ||
+                                (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR);
+                if (!is_error)
+                {
+                    continue;
+                }
+                sock_extended_err err;
+                std::memcpy(&err, CMSG_DATA(cm), sizeof(err));
+                if (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY || err.ee_errno != 0)
+                {
+                    continue;
+                }
+                markZeroCopyDone(err.ee_info, err.ee_data);
+                if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                {
+                    zerocopy_off = true;    // Pinning pages only to copy them costs more
+                }
+            }
+        }
+
+        while (!zerocopy_sends.empty() && zerocopy_sends.front().done)
+        {
+            zerocopy_sends.pop_front();
+            ++zerocopy_first;
+        }
+    }
+
+    // Sequence numbers wrap at 2^32; the unsigned differences below wrap with them.
+    void markZeroCopyDone(uint32_t lo, uint32_t hi)
+    {
+        for (uint32_t seq = lo;; ++seq)
+        {
+            uint32_t index = seq - zerocopy_first;
+            if (index < zerocopy_sends.size())
+            {
+                zerocopy_sends[index].done = true;
+            }
+            if (seq == hi)
+            {
+                break;
+            }
+        }
+    }
+
+    // sendfile() where the file allows it, else a pread() into the shared buffer.
+    // Whether it does is a property of the file (procfs, some FUSE mounts), so the
+    // fallback sticks to this item and the next file gets sendfile() again.
+    ssize_t sendFileChunk(Output& out)
+    {
+        if (!out.copy_file)
+        {
+            off_t offset = static_cast<off_t>(out.offset);
+            ssize_t sent = ::sendfile(fd, out.file_fd, &offset, std::min<uint64_t>(out.length, MaxFileChunk));
+            if (sent >= 0 || (errno != EINVAL && errno != ENOSYS))
+            {
+                return sent;
+            }
+            out.copy_file = true;
+        }
+
+        size_t chunk = std::min<uint64_t>(out.length, m_backend.m_file_buffer.size());
+        ssize_t bytes_read = pread(out.file_fd, m_backend.m_file_buffer.data(), chunk, out.offset);
+        if (bytes_read <= 0)
+        {
+            return bytes_read;
+        }
+        return ::send(fd, m_backend.m_file_buffer.data(), bytes_read, MSG_NOSIGNAL);
+    }
+
+    // Advances past bytes the socket accepted, which may span several items.
+    void consume(uint64_t sent)
+    {
+        while (sent > 0)
+        {
+            Output& out = pending.front();
+            uint64_t n = std::min(sent, out.length);
+            if (out.data != nullptr)
+            {
+                out.data += n;
+            }
+            out.offset += n;
+            out.length -= n;
+            sent -= n;
+            if (out.length == 0)
+            {
+                pending.pop_front();
+            }
+        }
+    }
+
+    void receive()
+    {
+        char* buffer = m_backend.m_recv_buffer.data();
+        size_t size = m_backend.m_recv_buffer.size();
+
+        while (!closed)
+        {
+            ssize_t n = recv(fd, buffer, size, 0);
+            if (n > 0)
+            {
+                channel->onReceive(buffer, n);
+                continue;
+            }
+            if (n == 0)
+            {
+                channel->onEndOfStream();
+                return;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                fail(errno);
+            }
+            return;
+        }
+    }
+
+    void fail(int error)
+    {
+        if (!closed)
+        {
+            channel->onError(error);
+        }
+    }
+};
+
+void EpollBackend::Listener::onEvents(uint32_t)
+{
+    while (true)
+    {
+        sockaddr_in client_addr{};
+        socklen_t client_len = sizeof(client_addr);
+        int client = accept4(m_fd, reinterpret_cast<sockaddr*>(&client_addr), &client_len,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            return;  // EAGAIN, or an error the next edge will report again
+        }
+
+        char ip[INET_ADDRSTRLEN] = {};
+        inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+
+        IoChannel* channel = m_acceptor->onAccept(client, ip);
+        if (channel == nullptr)
+        {
+            ::close(client);
+            continue;
+        }
+
+        auto socket = std::make_unique<Socket>(client, channel, m_backend);
+        m_backend.m_loop.add(client, EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET, socket.get());
+        m_backend.m_sockets.emplace(client, std::move(socket));
+    }
+}
+
+class EpollBackend::Ticker : public EventHandler
+{
+public:
+    Ticker(int fd, std::function<void(uint64_t)> tick)
+            : m_fd(fd)
+            , m_tick(std::move(tick))
+    {
+    }
+
+    ~Ticker() override
+    {
+        ::close(m_fd);
+    }
+
+    int fd() const { return m_fd; }
+
+    void onEvents(uint32_t) override
+    {
+        // The count covers expirations missed while the loop was busy
+        uint64_t ticks = 0;
+        uint64_t expirations;
+        while (read(m_fd, &expirations, sizeof(expirations)) > 0)
+        {
+            ticks += expirations;
+        }
+        if (ticks > 0)
+        {
+            m_tick(ticks);
+        }
+    }
+
+private:
+    int m_fd;
+    std::function<void(uint64_t)> m_tick;
+};
+
+EpollBackend::EpollBackend()
+        : m_recv_buffer(64 * 1024)
+        , m_file_buffer(64 * 1024)
+{
+}
+
+EpollBackend::~EpollBackend()
+{
+    for (auto& [fd, socket] : m_sockets)
+    {
+        ::close(fd);
+    }
+    for (auto& socket : m_lingering)
+    {
+        ::close(socket->fd);
+    }
+}
+
+void EpollBackend::listen(int listen_fd, bool exclusive, IoAcceptor* acceptor)
+{
+    auto listener = std::make_unique<Listener>(listen_fd, acceptor, *this);
+    // Several loops watching one socket: wake only one of them per connection
+    m_loop.add(listen_fd, exclusive ? (EPOLLIN | EPOLLEXCLUSIVE) : (EPOLLIN | EPOLLET), listener.get());
+    m_listeners.push_back(std::move(listener));
+}
+
+void EpollBackend::stopListening()
+{
+    for (auto& listener : m_listeners)
+    {
+        m_loop.remove(listener->fd());
+        m_loop.destroyLater(std::move(listener));
+    }
+    m_listeners.clear();
+}
+
+void EpollBackend::send(int fd, const char* data, size_t length)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ data, -1, 0, length, nullptr });
+    queueOutput(it->second.get());
+}
+
+void EpollBackend::sendFile(int fd, int file_fd, uint64_t offset, uint64_t length)
+{
+    // Nothing to read: queued, it would look like a file that shrank under us
+    if (length == 0)
+    {
+        return;
+    }
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ nullptr, file_fd, offset, length, nullptr });
+    queueOutput(it->second.get());
+}
+
+void EpollBackend::sendZeroCopy(int fd, const char* data, size_t length, std::shared_ptr<const void> owner)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ data, -1, 0, length, std::move(owner) });
+    queueOutput(it->second.get());
+}
+
+void EpollBackend::queueOutput(Socket* socket)
+{
+    // Writing starts once the current batch of events has been handled, so every
+    // response queued in that batch (e.g. a run of pipelined requests) leaves in
+    // one sendmsg(). Completion is likewise reported after the caller has unwound.
+    if (socket->flush_queued || socket->waiting_writable)
+    {
+        return;
+    }
+
+    socket->flush_queued = true;
+    m_loop.defer([socket] {
+        socket->flush_queued = false;
+        // An EPOLLOUT in the meantime may have drained (and reported) it already
+        if (socket->closed || socket->pending.empty())
+        {
+            return;
+        }
+        if (socket->flush() && !socket->closed)
+        {
+            socket->channel->onSendComplete();
+        }
+    });
+}
+
+void EpollBackend::close(int fd)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+
+    Socket* socket = it->second.get();
+    socket->closed = true;
+    if (socket->zeroCopyPending())
+    {
+        // The kernel may still be sending from memory the socket holds. The socket
+        // stays open, shut down, until the last completion or LingerLimit.
+        shutdown(fd, SHUT_RDWR);
+        socket->lingering_since = std::chrono::steady_clock::now();
+        m_lingering.push_back(std::move(it->second));
+        m_sockets.erase(it);
+        return;
+    }
+
+    m_loop.remove(fd);
+    ::close(fd);
+    m_loop.destroyLater(std::move(it->second));
+    m_sockets.erase(it);
+}
+
+void EpollBackend::endLinger(Socket* socket)
+{
+    auto it = std::find_if(m_lingering.begin(), m_lingering.end(),
+                           [socket](const std::unique_ptr<Socket>& s) { return s.get() == socket; });
+    if (it == m_lingering.end())
+    {
+        return;
+    }
+    m_loop.remove(socket->fd);
+    ::close(socket->fd);
+    m_loop.destroyLater(std::move(*it));
+    m_lingering.erase(it);
+}
+
+void EpollBackend::reapLingering()
+{
+    auto cutoff = std::chrono::steady_clock::now() - LingerLimit;
+    for (size_t i = m_lingering.size(); i-- > 0;)
+    {
+        if (m_lingering[i]->lingering_since < cutoff)
+        {
+            endLinger(m_lingering[i].get());
+        }
+    }
+}
+
+void EpollBackend::deleteLater(std::unique_ptr<IoChannel> channel)
+{
+    m_loop.defer([raw = channel.release()] { delete raw; });
+}
+
+void EpollBackend::post(std::function<void()> task)
+{
+    m_loop.post(std::move(task));
+}
+
+void EpollBackend::setTick(std::chrono::milliseconds interval, std::function<void(uint64_t ticks)> tick)
+{
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (fd < 0)
+    {
+        throw std::runtime_error(std::string("timerfd_create failed: ") + strerror(errno));
+    }
+
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(fd, 0, &spec, nullptr);
+
+    if (m_ticker)
+    {
+        m_loop.remove(m_ticker->fd());
+        m_loop.destroyLater(std::move(m_ticker));
+    }
+    m_ticker = std::make_unique<Ticker>(fd, [this, tick = std::move(tick)](uint64_t ticks) {
+        reapLingering();
+        tick(ticks);
+    });
+    m_loop.add(fd, EPOLLIN | EPOLLET, m_ticker.get());
+}
+
+void EpollBackend::run()
+{
+    m_loop.run();
+}
+
+void EpollBackend::stop()
+{
+    m_loop.stop();
+}
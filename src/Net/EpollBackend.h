@@ -0,0 +1,52 @@
+#pragma once
+
+#include "EventLoop.h"
+#include "IoBackend.h"
+
+#include <deque>
+#include <unordered_map>
+#include <vector>
+
+// Readiness-based backend: edge-triggered epoll plus non-blocking recv/send.
+class EpollBackend : public IoBackend
+{
+public:
+    EpollBackend();
+    ~EpollBackend() override;
+
+    const char* name() const override { return "epoll"; }
+
+    void listen(int listen_fd, bool exclusive, IoAcceptor* acceptor) override;
+    void stopListening() override;
+    void send(int fd, const char* data, size_t length) override;
+    void sendFile(int fd, int file_fd, uint64_t offset, uint64_t length) override;
+    void sendZeroCopy(int fd, const char* data, size_t length, std::shared_ptr<const void> owner) override;
+    void close(int fd) override;
+    void deleteLater(std::unique_ptr<IoChannel> channel) override;
+    void post(std::function<void()> task) override;
+    void setTick(std::chrono::milliseconds interval, std::function<void(uint64_t ticks)> tick) override;
+    void run() override;
+    void stop() override;
+
+private:
+    class Listener;
+    class Socket;
+    class Ticker;
+
+    EventLoop m_loop;
+    std::vector<std::unique_ptr<Listener>> m_listeners;
+    std::unique_ptr<Ticker> m_ticker;
+    std::unordered_map<int, std::unique_ptr<Socket>> m_sockets;
+    std::vector<std::unique_ptr<Socket>> m_lingering;   // Closed, zero-copy sends outstanding
+
+    // Scratch space shared by every socket on this loop
+    std::vector<char> m_recv_buffer;
+    std::vector<char> m_file_buffer;  // Only used for files sendfile() refuses
+
+    // How long a closed socket waits for its zero-copy completions
+    static constexpr std::chrono::seconds LingerLimit{ 10 };
+
+    void queueOutput(Socket* socket);
+    void endLinger(Socket* socket);
+    void reapLingering();
+};
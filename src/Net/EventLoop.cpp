@@ -0,0 +1,171 @@
+#include "EventLoop.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+EventLoop::EventLoop()
+        : m_epoll_fd(epoll_create1(EPOLL_CLOEXEC))
+        , m_wake_fd(-1)
+{
+    if (m_epoll_fd < 0)
+    {
+        throw std::runtime_error(std::string("epoll_create1 failed: ") + strerror(errno));
+    }
+
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wake_fd < 0)
+    {
+        close(m_epoll_fd);
+        throw std::runtime_error(std::string("eventfd failed: ") + strerror(errno));
+    }
+
+    // The wakeup fd is the only registration without a handler behind it.
+    add(m_wake_fd, EPOLLIN | EPOLLET, nullptr);
+}
+
+EventLoop::~EventLoop()
+{
+    close(m_wake_fd);
+    close(m_epoll_fd);
+}
+
+void EventLoop::add(int fd, uint32_t events, EventHandler* handler)
+{
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = handler;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        throw std::runtime_error(std::string("epoll_ctl(ADD) failed: ") + strerror(errno));
+    }
+}
+
+void EventLoop::modify(int fd, uint32_t events, EventHandler* handler)
+{
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.ptr = handler;
+    if (epoll_ctl(m_epoll_fd, EPOLL_CTL_MOD, fd, &ev) < 0)
+    {
+        throw std::runtime_error(std::string("epoll_ctl(MOD) failed: ") + strerror(errno));
+    }
+}
+
+void EventLoop::remove(int fd)
+{
+    // Failure only means the fd was already gone, which is what the caller wanted.
+    epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+void EventLoop::destroyLater(std::unique_ptr<EventHandler> handler)
+{
+    m_graveyard.push_back(std::move(handler));
+}
+
+void EventLoop::defer(std::function<void()> task)
+{
+    m_deferred.push_back(std::move(task));
+}
+
+void EventLoop::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_posted.push_back(std::move(task));
+    }
+    wake();
+}
+
+void EventLoop::run()
+{
+    std::array<epoll_event, 256> events;
+
+    while (!m_stop_requested.load(std::memory_order_acquire))
+    {
+        int n = epoll_wait(m_epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw std::runtime_error(std::string("epoll_wait failed: ") + strerror(errno));
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+            auto* handler = static_cast<EventHandler*>(events[i].data.ptr);
+            if (handler == nullptr)
+            {
+                drainWakeups();
+            }
+            else
+            {
+                handler->onEvents(events[i].events);
+            }
+        }
+
+        runPosted();
+        runDeferred();
+        m_graveyard.clear();
+    }
+}
+
+void EventLoop::stop()
+{
+    m_stop_requested.store(true, std::memory_order_release);
+    wake();
+}
+
+void EventLoop::wake()
+{
+    uint64_t one = 1;
+    // EAGAIN means the counter is already non-zero, so the loop is waking anyway.
+    [[maybe_unused]] ssize_t n = write(m_wake_fd, &one, sizeof(one));
+}
+
+void EventLoop::drainWakeups()
+{
+    uint64_t count;
+    while (read(m_wake_fd, &count, sizeof(count)) > 0)
+    {
+    }
+}
+
+void EventLoop::runPosted()
+{
+    // Both lists keep their capacity across the swap, so a busy loop doesn't allocate
+    // for them once they've grown.
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_running.swap(m_posted);
+    }
+
+    for (auto& task : m_running)
+    {
+        task();
+    }
+    m_running.clear();
+}
+
+void EventLoop::runDeferred()
+{
+    // Deferred tasks may defer more work; keep going until the batch settles.
+    while (!m_deferred.empty())
+    {
+        m_running.swap(m_deferred);
+
+        for (auto& task : m_running)
+        {
+            task();
+        }
+        m_running.clear();
+    }
+}
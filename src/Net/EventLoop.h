@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Anything that owns a file descriptor registered with an EventLoop.
+class EventHandler
+{
+public:
+    virtual ~EventHandler() = default;
+    virtual void onEvents(uint32_t events) = 0;
+};
+
+// Edge-triggered epoll reactor (Linux only).
+// A loop is driven by exactly one thread; post() and stop() are the only calls
+// that are safe from other threads.
+class EventLoop
+{
+public:
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    void add(int fd, uint32_t events, EventHandler* handler);
+    void modify(int fd, uint32_t events, EventHandler* handler);
+    void remove(int fd);
+
+    // Handlers are destroyed after the current batch of events has been dispatched,
+    // so an event already returned by epoll_wait never reaches a freed handler.
+    void destroyLater(std::unique_ptr<EventHandler> handler);
+
+    // Loop thread only: run task once the current batch of events has been dispatched.
+    void defer(std::function<void()> task);
+
+    // Queue a task to run on the loop thread and wake the loop up.
+    void post(std::function<void()> task);
+
+    void run();
+    void stop();
+
+private:
+    int m_epoll_fd;
+    int m_wake_fd;
+    std::atomic<bool> m_stop_requested{false};
+
+    std::mutex m_post_mutex;
+    std::vector<std::function<void()>> m_posted;
+    std::vector<std::function<void()>> m_deferred;
+    std::vector<std::function<void()>> m_running;   // Whichever list is being run
+    std::vector<std::unique_ptr<EventHandler>> m_graveyard;
+
+    void wake();
+    void drainWakeups();
+    void runPosted();
+    void runDeferred();
+};
@@ -0,0 +1,28 @@
+#include "IoBackend.h"
+#include "EpollBackend.h"
+#include "UringBackend.h"
+
+#include <stdexcept>
+
+std::unique_ptr<IoBackend> createIoBackend(const std::string& preferred, std::string& fallback_reason)
+{
+    fallback_reason.clear();
+
+    if (preferred == "io_uring" || preferred == "auto")
+    {
+        try
+        {
+            return std::make_unique<UringBackend>();
+        }
+        catch (const std::exception& e)
+        {
+            fallback_reason = e.what();
+        }
+    }
+    else if (preferred != "epoll")
+    {
+        throw std::runtime_error("Unknown I/O backend: " + preferred);
+    }
+
+    return std::make_unique<EpollBackend>();
+}
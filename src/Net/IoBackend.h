@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// One connected socket as seen by an IoBackend. Callbacks always arrive on the
+// backend's thread and never re-enter a send()/sendFile() call.
+class IoChannel
+{
+public:
+    virtual ~IoChannel() = default;
+
+    virtual void onReceive(const char* data, size_t length) = 0;
+    virtual void onEndOfStream() = 0;            // Peer shut down its sending side
+    virtual void onError(int error) = 0;         // Socket is unusable; close it
+    virtual void onSendProgress() = 0;           // Some queued output was written
+    virtual void onSendComplete() = 0;           // Everything queued so far is on the wire
+};
+
+class IoAcceptor
+{
+public:
+    virtual ~IoAcceptor() = default;
+
+    // Returns the channel that receives this connection's I/O, or nullptr to refuse it.
+    virtual IoChannel* onAccept(int fd, std::string client_ip) = 0;
+};
+
+// Connection I/O for one worker thread. Implementations own the accept, receive and
+// send paths; callers queue output and get told when it has drained.
+class IoBackend
+{
+public:
+    virtual ~IoBackend() = default;
+
+    virtual const char* name() const = 0;
+
+    // exclusive: several backends watch the same listening socket.
+    virtual void listen(int listen_fd, bool exclusive, IoAcceptor* acceptor) = 0;
+
+    // Stops accepting on every listener. The listening sockets belong to the caller,
+    // who may close them once this returns.
+    virtual void stopListening() = 0;
+
+    // Queued output goes out in order. Memory passed to send() and the file passed to
+    // sendFile() must stay valid until onSendComplete() or close().
+    virtual void send(int fd, const char* data, size_t length) = 0;
+    virtual void sendFile(int fd, int file_fd, uint64_t offset, uint64_t length) = 0;
+
+    // Like send(), but with MSG_ZEROCOPY where the socket allows it: the kernel sends
+    // straight from data, and may still be reading it after onSendComplete(). The
+    // backend holds owner, which keeps data alive, until the kernel says it is done.
+    virtual void sendZeroCopy(int fd, const char* data, size_t length, std::shared_ptr<const void> owner) = 0;
+
+    // Stops all callbacks for fd and closes it. Operations already in flight are
+    // cancelled or left to complete silently.
+    virtual void close(int fd) = 0;
+
+    // Destroy a channel once the backend can no longer be inside one of its callbacks.
+    virtual void deleteLater(std::unique_ptr<IoChannel> channel) = 0;
+
+    // Thread-safe: run task on the backend's thread.
+    virtual void post(std::function<void()> task) = 0;
+
+    // Call tick on the backend's thread every interval while run() is active, with the
+    // number of intervals that have passed since the last call: more than one when the
+    // loop was too busy to get to it in time. Meant for housekeeping such as idle
+    // timeouts; set it before run().
+    virtual void setTick(std::chrono::milliseconds interval, std::function<void(uint64_t ticks)> tick) = 0;
+
+    virtual void run() = 0;
+    virtual void stop() = 0;            // Thread-safe
+};
+
+// preferred is "epoll", "io_uring" or "auto". io_uring falls back to epoll at runtime
+// when the kernel lacks it (or a feature it needs); fallback_reason says why.
+std::unique_ptr<IoBackend> createIoBackend(const std::string& preferred, std::string& fallback_reason);
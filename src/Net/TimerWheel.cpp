@@ -0,0 +1,132 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+TimerWheel::Timer::Timer(std::function<void()> on_expire)
+        : m_on_expire(std::move(on_expire))
+{
+}
+
+TimerWheel::Timer::~Timer()
+{
+    if (m_wheel != nullptr)
+    {
+        m_wheel->cancel(*this);
+    }
+}
+
+TimerWheel::~TimerWheel()
+{
+    // Timers may outlive the wheel; leave none pointing at it.
+    for (auto& level : m_slots)
+    {
+        for (Timer*& head : level)
+        {
+            while (head != nullptr)
+            {
+                unlink(*head);
+            }
+        }
+    }
+}
+
+void TimerWheel::schedule(Timer& timer, uint64_t delay)
+{
+    if (timer.m_wheel != nullptr)
+    {
+        unlink(timer);
+    }
+    timer.m_expires = m_now + std::max<uint64_t>(delay, 1);
+    insert(timer);
+}
+
+void TimerWheel::cancel(Timer& timer)
+{
+    if (timer.m_wheel == this)
+    {
+        unlink(timer);
+    }
+}
+
+void TimerWheel::advance()
+{
+    ++m_now;
+
+    // Each time a level's index wraps, pull the next slot of the level above down
+    // into the finer levels.
+    for (unsigned level = 1; level < Levels; ++level)
+    {
+        if ((m_now & ((uint64_t{ 1 } << (SlotBits * level)) - 1)) != 0)
+        {
+            break;
+        }
+        Timer*& head = m_slots[level][(m_now >> (SlotBits * level)) & (Slots - 1)];
+        while (head != nullptr)
+        {
+            Timer& timer = *head;
+            unlink(timer);
+            insert(timer);
+        }
+    }
+
+    // Callbacks may arm or cancel any timer, including the rest of this slot, so
+    // take one at a time off the head. Re-armed timers always land in a later slot.
+    Timer*& due = m_slots[0][m_now & (Slots - 1)];
+    while (due != nullptr)
+    {
+        Timer& timer = *due;
+        unlink(timer);
+        if (timer.m_expires <= m_now)
+        {
+            timer.m_on_expire();
+        }
+        else
+        {
+            insert(timer);  // Was beyond the wheel's range when scheduled
+        }
+    }
+}
+
+void TimerWheel::insert(Timer& timer)
+{
+    uint64_t expires = std::min(timer.m_expires, m_now + MaxDelay);
+    uint64_t delta = expires - m_now;
+
+    unsigned level = 0;
+    while (level + 1 < Levels && delta >= (uint64_t{ 1 } << (SlotBits * (level + 1))))
+    {
+        ++level;
+    }
+
+    Timer*& head = m_slots[level][(expires >> (SlotBits * level)) & (Slots - 1)];
+    timer.m_wheel = this;
+    timer.m_slot = &head;
+    timer.m_prev = nullptr;
+    timer.m_next = head;
+    if (head != nullptr)
+    {
+        head->m_prev = &timer;
+    }
+    head = &timer;
+}
+
+void TimerWheel::unlink(Timer& timer)
+{
+    if (timer.m_prev != nullptr)
+    {
+        timer.m_prev->m_next = timer.m_next;
+    }
+    else
+    {
+        *timer.m_slot = timer.m_next;
+    }
+    if (timer.m_next != nullptr)
+    {
+        timer.m_next->m_prev = timer.m_prev;
+    }
+
+    timer.m_wheel = nullptr;
+    timer.m_slot = nullptr;
+    timer.m_prev = nullptr;
+    timer.m_next = nullptr;
+}
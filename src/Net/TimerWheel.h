@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+// Hashed hierarchical timer wheel for one event loop: four levels of 64 slots, so
+// scheduling, cancelling and each tick are O(1) (amortised over cascades) however many
+// timers are armed. Time is counted in ticks; the owner calls advance() once per tick.
+//
+// Timers are intrusive: the owner embeds a Timer, arming it never allocates, and
+// destroying it disarms it. Deadlines that move with activity (e.g. idle timeouts)
+// are best checked lazily: leave the timer alone on activity and, when it fires,
+// schedule it again for whatever time remains.
+//
+// Loop thread only.
+class TimerWheel
+{
+public:
+    class Timer
+    {
+    public:
+        explicit Timer(std::function<void()> on_expire);
+        ~Timer();
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool armed() const { return m_wheel != nullptr; }
+
+    private:
+        friend class TimerWheel;
+
+        std::function<void()> m_on_expire;
+        TimerWheel* m_wheel = nullptr;
+        Timer* m_prev = nullptr;
+        Timer* m_next = nullptr;
+        Timer** m_slot = nullptr;
+        uint64_t m_expires = 0;
+    };
+
+    TimerWheel() = default;
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    uint64_t now() const { return m_now; }
+
+    // Arms (or re-arms) timer to fire delay ticks from now; a delay of 0 counts as 1.
+    void schedule(Timer& timer, uint64_t delay);
+    void cancel(Timer& timer);
+
+    // Moves time on by one tick and fires whatever is due.
+    void advance();
+
+private:
+    static constexpr unsigned SlotBits = 6;
+    static constexpr uint64_t Slots = uint64_t{ 1 } << SlotBits;
+    static constexpr unsigned Levels = 4;
+    static constexpr uint64_t MaxDelay = (uint64_t{ 1 } << (SlotBits * Levels)) - 1;
+
+    std::array<std::array<Timer*, Slots>, Levels> m_slots{};
+    uint64_t m_now = 0;
+
+    void insert(Timer& timer);
+    void unlink(Timer& timer);
+};
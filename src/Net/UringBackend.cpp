@@ -0,0 +1,966 @@
+#include "UringBackend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <stdexcept>
+#include <string>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr unsigned RecvBufferCount = 256;          // Power of two
+    constexpr unsigned RecvBufferSize = 16 * 1024;
+    constexpr uint16_t RecvBufferGroup = 0;
+    constexpr size_t FileChunkSize = 64 * 1024;
+    constexpr size_t MaxGather = 64;                   // Memory items per SENDMSG
+
+    int ioUringSetup(unsigned entries, io_uring_params* params)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, _NSIG / 8));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, void* arg, unsigned nr_args)
+    {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+    template <typename T>
+    T loadAcquire(T* p)
+    {
+        return std::atomic_ref<T>(*p).load(std::memory_order_acquire);
+    }
+
+    template <typename T>
+    void storeRelease(T* p, T value)
+    {
+        std::atomic_ref<T>(*p).store(value, std::memory_order_release);
+    }
+
+    // Multishot recv with provided buffers landed in 6.0.
+    bool kernelAtLeast(int major, int minor)
+    {
+        utsname info{};
+        int have_major = 0;
+        int have_minor = 0;
+        if (uname(&info) != 0 || std::sscanf(info.release, "%d.%d", &have_major, &have_minor) != 2)
+        {
+            return false;
+        }
+        return have_major > major || (have_major == major && have_minor >= minor);
+    }
+}
+
+struct UringBackend::Listener
+{
+    int fd;
+    IoAcceptor* acceptor;
+    bool stopped = false;
+};
+
+// One SEND_ZC op and the memory it sends from, held until its notification
+struct UringBackend::ZeroCopySend
+{
+    Socket* socket;
+    std::shared_ptr<const void> owner;
+};
+
+struct UringBackend::Socket
+{
+    struct Output
+    {
+        const char* data;       // nullptr for file output
+        int file_fd;
+        uint64_t offset;
+        uint64_t length;
+        std::shared_ptr<const void> owner;  // Set for zero-copy output
+    };
+
+    int fd;
+    IoChannel* channel;
+    bool closed = false;
+    unsigned inflight = 0;
+
+    std::deque<Output> pending;
+    bool sending = false;
+    bool send_queued = false;       // Listed in m_send_ready
+
+    // Gathered memory output for SENDMSG; must outlive the op
+    iovec iov[MaxGather];
+    msghdr msg{};
+
+    // File output goes through this buffer: READ linked to SEND, then any leftovers
+    std::unique_ptr<char[]> staging;
+    uint32_t staged = 0;            // Bytes of the current chunk in staging
+    uint32_t staged_sent = 0;
+    unsigned link_outstanding = 0;  // CQEs still due from a READ+SEND pair
+    int32_t link_read_result = INT32_MIN;
+    int32_t link_send_result = 0;
+
+    bool recv_starved = false;      // Multishot recv stopped for lack of buffers
+
+    // SEND_ZC ops whose notification hasn't arrived; each is its op's user_data
+    std::list<ZeroCopySend> zerocopy_sends;
+};
+
+UringBackend::UringBackend(unsigned queue_depth)
+{
+    if (!kernelAtLeast(6, 0))
+    {
+        throw std::runtime_error("io_uring backend needs Linux 6.0 or newer");
+    }
+
+    io_uring_params params{};
+    params.flags = IORING_SETUP_COOP_TASKRUN;
+    m_ring_fd = ioUringSetup(queue_depth, &params);
+    if (m_ring_fd < 0)
+    {
+        throw std::runtime_error(std::string("io_uring_setup failed: ") + strerror(errno));
+    }
+
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        ::close(m_ring_fd);
+        throw std::runtime_error("io_uring lacks IORING_FEAT_SINGLE_MMAP");
+    }
+
+    m_sq_ring_size = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    m_sq_ring = mmap(nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     m_ring_fd, IORING_OFF_SQ_RING);
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = mmap(nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      m_ring_fd, IORING_OFF_SQES);
+    if (m_sq_ring == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        if (m_sq_ring != MAP_FAILED)
+        {
+            munmap(m_sq_ring, m_sq_ring_size);
+        }
+        m_sq_ring = nullptr;
+        ::close(m_ring_fd);
+        throw std::runtime_error("io_uring ring mmap failed");
+    }
+
+    auto* ring = static_cast<char*>(m_sq_ring);
+    m_sq_head = reinterpret_cast<unsigned*>(ring + params.sq_off.head);
+    m_sq_tail = reinterpret_cast<unsigned*>(ring + params.sq_off.tail);
+    m_sq_mask = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_mask);
+    m_sq_entries = *reinterpret_cast<unsigned*>(ring + params.sq_off.ring_entries);
+    m_sq_array = reinterpret_cast<unsigned*>(ring + params.sq_off.array);
+    m_sq_local_tail = *m_sq_tail;
+    m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+    m_cq_head = reinterpret_cast<unsigned*>(ring + params.cq_off.head);
+    m_cq_tail = reinterpret_cast<unsigned*>(ring + params.cq_off.tail);
+    m_cq_mask = *reinterpret_cast<unsigned*>(ring + params.cq_off.ring_mask);
+    m_cqes = reinterpret_cast<io_uring_cqe*>(ring + params.cq_off.cqes);
+
+    // Provided buffer ring: the kernel picks a buffer per multishot recv completion
+    m_buf_ring_size = RecvBufferCount * sizeof(io_uring_buf);
+    void* buf_ring = mmap(nullptr, m_buf_ring_size, PROT_READ | PROT_WRITE, MAP_ANONYMOUS | MAP_PRIVATE, -1, 0);
+    if (buf_ring == MAP_FAILED)
+    {
+        teardown();
+        throw std::runtime_error("io_uring buffer ring mmap failed");
+    }
+    m_buf_ring = static_cast<io_uring_buf_ring*>(buf_ring);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(m_buf_ring);
+    reg.ring_entries = RecvBufferCount;
+    reg.bgid = RecvBufferGroup;
+    if (ioUringRegister(m_ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        int error = errno;
+        teardown();
+        throw std::runtime_error(std::string("io_uring provided buffer ring unsupported: ") + strerror(error));
+    }
+
+    m_buffers.resize(static_cast<size_t>(RecvBufferCount) * RecvBufferSize);
+    for (unsigned bid = 0; bid < RecvBufferCount; ++bid)
+    {
+        recycleBuffer(static_cast<uint16_t>(bid));
+    }
+
+    m_wake_fd = eventfd(0, EFD_CLOEXEC);
+    if (m_wake_fd < 0)
+    {
+        teardown();
+        throw std::runtime_error(std::string("eventfd failed: ") + strerror(errno));
+    }
+    armWake();
+}
+
+UringBackend::~UringBackend()
+{
+    teardown();
+}
+
+void UringBackend::teardown()
+{
+    // Closing the ring cancels everything still in flight
+    if (m_ring_fd >= 0)
+    {
+        ::close(m_ring_fd);
+        m_ring_fd = -1;
+    }
+    if (m_sq_ring != nullptr)
+    {
+        munmap(m_sq_ring, m_sq_ring_size);
+        munmap(m_sqes, m_sqes_size);
+        m_sq_ring = nullptr;
+    }
+    if (m_buf_ring != nullptr)
+    {
+        munmap(m_buf_ring, m_buf_ring_size);
+        m_buf_ring = nullptr;
+    }
+    if (m_wake_fd >= 0)
+    {
+        ::close(m_wake_fd);
+        m_wake_fd = -1;
+    }
+    if (m_tick_fd >= 0)
+    {
+        ::close(m_tick_fd);
+        m_tick_fd = -1;
+    }
+    for (auto& [fd, socket] : m_sockets)
+    {
+        ::close(fd);
+    }
+    for (auto& socket : m_closing)
+    {
+        ::close(socket->fd);
+    }
+    m_sockets.clear();
+    m_closing.clear();
+}
+
+io_uring_sqe* UringBackend::nextSqe()
+{
+    if (m_sq_local_tail - loadAcquire(m_sq_head) >= m_sq_entries)
+    {
+        submit(0);
+    }
+
+    unsigned index = m_sq_local_tail & m_sq_mask;
+    io_uring_sqe* sqe = &m_sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    m_sq_array[index] = index;
+    ++m_sq_local_tail;
+    ++m_unsubmitted;
+    return sqe;
+}
+
+void UringBackend::submit(unsigned wait_for)
+{
+    storeRelease(m_sq_tail, m_sq_local_tail);
+
+    unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+    while (true)
+    {
+        int ret = ioUringEnter(m_ring_fd, m_unsubmitted, wait_for, flags);
+        if (ret >= 0)
+        {
+            m_unsubmitted -= std::min<unsigned>(ret, m_unsubmitted);
+            return;
+        }
+        if (errno == EINTR)
+        {
+            if (wait_for > 0)
+            {
+                return;  // Let the loop re-check the stop flag
+            }
+            continue;
+        }
+        if (errno == EAGAIN || errno == EBUSY)
+        {
+            return;  // Completion queue backed up; reaping it makes room
+        }
+        throw std::runtime_error(std::string("io_uring_enter failed: ") + strerror(errno));
+    }
+}
+
+void UringBackend::listen(int listen_fd, bool, IoAcceptor* acceptor)
+{
+    // The ring does its own waiting; a blocking listener keeps accept from
+    // completing with -EAGAIN instead of being parked until a client arrives.
+    int flags = fcntl(listen_fd, F_GETFL);
+    fcntl(listen_fd, F_SETFL, flags & ~O_NONBLOCK);
+
+    m_listeners.push_back(std::make_unique<Listener>(Listener{ listen_fd, acceptor, false }));
+    armAccept(m_listeners.back().get());
+}
+
+void UringBackend::stopListening()
+{
+    // The listeners stay allocated until the backend goes: the cancelled accepts
+    // still complete against them.
+    for (auto& listener : m_listeners)
+    {
+        if (listener->stopped)
+        {
+            continue;
+        }
+        listener->stopped = true;
+
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->addr = reinterpret_cast<uint64_t>(listener.get()) | OpAccept;
+        sqe->user_data = OpCancel;
+    }
+}
+
+void UringBackend::armAccept(Listener* listener)
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listener->fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->user_data = reinterpret_cast<uint64_t>(listener) | OpAccept;
+}
+
+void UringBackend::armRecv(Socket* socket)
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = socket->fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = RecvBufferGroup;
+    sqe->user_data = reinterpret_cast<uint64_t>(socket) | OpRecv;
+    ++socket->inflight;
+}
+
+void UringBackend::armWake()
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = m_wake_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&m_wake_value);
+    sqe->len = sizeof(m_wake_value);
+    sqe->user_data = OpWake;
+}
+
+void UringBackend::armTick()
+{
+    io_uring_sqe* sqe = nextSqe();
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = m_tick_fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&m_tick_expirations);
+    sqe->len = sizeof(m_tick_expirations);
+    sqe->user_data = OpTick;
+}
+
+void UringBackend::recycleBuffer(uint16_t bid)
+{
+    // The ring is an array of io_uring_buf whose first entry overlays the tail. The
+    // header's bufs[] member is a flex array that sits at the wrong offset in C++.
+    io_uring_buf* buf = reinterpret_cast<io_uring_buf*>(m_buf_ring) + (m_buf_tail & (RecvBufferCount - 1));
+    buf->addr = reinterpret_cast<uint64_t>(m_buffers.data() + static_cast<size_t>(bid) * RecvBufferSize);
+    buf->len = RecvBufferSize;
+    buf->bid = bid;
+    ++m_buf_tail;
+    storeRelease(&m_buf_ring->tail, m_buf_tail);
+}
+
+void UringBackend::send(int fd, const char* data, size_t length)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ data, -1, 0, length, nullptr });
+    queueSend(it->second.get());
+}
+
+void UringBackend::sendZeroCopy(int fd, const char* data, size_t length, std::shared_ptr<const void> owner)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ data, -1, 0, length, std::move(owner) });
+    queueSend(it->second.get());
+}
+
+void UringBackend::sendFile(int fd, int file_fd, uint64_t offset, uint64_t length)
+{
+    // Nothing to read: queued, it would look like a file that shrank under us
+    if (length == 0)
+    {
+        return;
+    }
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+    it->second->pending.push_back({ nullptr, file_fd, offset, length, nullptr });
+    queueSend(it->second.get());
+}
+
+// Sends start once the current batch of completions has been handled, so all output
+// queued in that batch (e.g. responses to pipelined requests) goes down as one op.
+void UringBackend::queueSend(Socket* socket)
+{
+    if (socket->send_queued || socket->sending)
+    {
+        return;
+    }
+    socket->send_queued = true;
+    m_send_ready.push_back(socket->fd);
+}
+
+void UringBackend::startQueuedSends()
+{
+    m_send_starting.swap(m_send_ready);
+    for (int fd : m_send_starting)
+    {
+        auto it = m_sockets.find(fd);
+        if (it != m_sockets.end())
+        {
+            it->second->send_queued = false;
+            startSend(it->second.get());
+        }
+    }
+    m_send_starting.clear();
+}
+
+// One send is in flight per socket at a time, which keeps the byte stream in order.
+void UringBackend::startSend(Socket* socket)
+{
+    if (socket->sending || socket->closed || socket->pending.empty())
+    {
+        return;
+    }
+    socket->sending = true;
+
+    Socket::Output& out = socket->pending.front();
+    if (out.owner)
+    {
+        // Sent on its own: the notification for this op is what releases the memory
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_SEND_ZC;
+        sqe->fd = socket->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(out.data);
+        sqe->len = static_cast<uint32_t>(std::min<uint64_t>(out.length, INT_MAX));
+        sqe->msg_flags = MSG_NOSIGNAL;
+        ZeroCopySend& send = socket->zerocopy_sends.emplace_back(ZeroCopySend{ socket, out.owner });
+        sqe->user_data = reinterpret_cast<uint64_t>(&send) | OpSendZc;
+        ++socket->inflight;
+        return;
+    }
+
+    if (out.data != nullptr)
+    {
+        size_t count = 0;
+        for (auto it = socket->pending.begin();
+             it != socket->pending.end() && it->data != nullptr && !it->owner && count < MaxGather; ++it)
+        {
+            socket->iov[count].iov_base = const_cast<char*>(it->data);
+            socket->iov[count].iov_len = it->length;
+            ++count;
+        }
+
+        io_uring_sqe* sqe = nextSqe();
+        sqe->fd = socket->fd;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = reinterpret_cast<uint64_t>(socket) | OpSend;
+        if (count == 1)
+        {
+            sqe->opcode = IORING_OP_SEND;
+            sqe->addr = reinterpret_cast<uint64_t>(out.data);
+            sqe->len = static_cast<uint32_t>(std::min<uint64_t>(out.length, INT_MAX));
+        }
+        else
+        {
+            socket->msg = msghdr{};
+            socket->msg.msg_iov = socket->iov;
+            socket->msg.msg_iovlen = count;
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->addr = reinterpret_cast<uint64_t>(&socket->msg);
+            sqe->len = 1;
+        }
+        ++socket->inflight;
+        return;
+    }
+
+    if (!socket->staging)
+    {
+        socket->staging = std::make_unique<char[]>(FileChunkSize);
+    }
+
+    if (socket->staged_sent < socket->staged)
+    {
+        // Finish a chunk the previous send only partly wrote
+        io_uring_sqe* sqe = nextSqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = socket->fd;
+        sqe->addr = reinterpret_cast<uint64_t>(socket->staging.get() + socket->staged_sent);
+        sqe->len = socket->staged - socket->staged_sent;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = reinterpret_cast<uint64_t>(socket) | OpSend;
+        ++socket->inflight;
+        return;
+    }
+
+    // Disk read and socket send go down together; the kernel starts the send as
+    // soon as the read lands, without a trip back through this thread.
+    uint32_t chunk = static_cast<uint32_t>(std::min<uint64_t>(out.length, FileChunkSize));
+    socket->staged = chunk;
+    socket->staged_sent = 0;
+    socket->link_outstanding = 2;
+
+    io_uring_sqe* read_sqe = nextSqe();
+    read_sqe->opcode = IORING_OP_READ;
+    read_sqe->fd = out.file_fd;
+    read_sqe->off = out.offset;
+    read_sqe->addr = reinterpret_cast<uint64_t>(socket->staging.get());
+    read_sqe->len = chunk;
+    read_sqe->flags = IOSQE_IO_LINK;
+    read_sqe->user_data = reinterpret_cast<uint64_t>(socket) | OpFileRead;
+
+    io_uring_sqe* send_sqe = nextSqe();
+    send_sqe->opcode = IORING_OP_SEND;
+    send_sqe->fd = socket->fd;
+    send_sqe->addr = reinterpret_cast<uint64_t>(socket->staging.get());
+    send_sqe->len = chunk;
+    send_sqe->msg_flags = MSG_NOSIGNAL;
+    send_sqe->user_data = reinterpret_cast<uint64_t>(socket) | OpSend;
+
+    socket->inflight += 2;
+}
+
+void UringBackend::onSendDone(Socket* socket, int32_t res)
+{
+    socket->sending = false;
+    if (socket->closed)
+    {
+        return;
+    }
+
+    Socket::Output& out = socket->pending.front();
+    if (out.data != nullptr)
+    {
+        if (res < 0)
+        {
+            socket->channel->onError(-res);
+            return;
+        }
+        socket->channel->onSendProgress();
+
+        // A gathered send may have covered several items
+        uint64_t sent = static_cast<uint64_t>(res);
+        while (sent > 0)
+        {
+            Socket::Output& front = socket->pending.front();
+            uint64_t n = std::min(sent, front.length);
+            front.data += n;
+            front.length -= n;
+            sent -= n;
+            if (front.length == 0)
+            {
+                socket->pending.pop_front();
+            }
+        }
+    }
+    else
+    {
+        int32_t read_result = socket->link_read_result;
+        socket->link_read_result = INT32_MIN;
+
+        if (read_result != INT32_MIN)
+        {
+            // Completing a READ+SEND pair
+            if (read_result <= 0)
+            {
+                socket->channel->onError(read_result == 0 ? EIO : -read_result);
+                return;
+            }
+            if (res == -ECANCELED)
+            {
+                // Short read broke the link; send what did arrive
+                socket->staged = read_result;
+                res = 0;
+            }
+        }
+        if (res < 0)
+        {
+            socket->channel->onError(-res);
+            return;
+        }
+
+        if (res > 0)
+        {
+            socket->channel->onSendProgress();
+        }
+        socket->staged_sent += res;
+        if (socket->staged_sent == socket->staged)
+        {
+            out.offset += socket->staged;
+            out.length -= socket->staged;
+            socket->staged = 0;
+            socket->staged_sent = 0;
+        }
+        if (out.length == 0)
+        {
+            socket->pending.pop_front();
+        }
+    }
+
+    if (socket->pending.empty())
+    {
+        socket->channel->onSendComplete();
+    }
+    else
+    {
+        startSend(socket);
+    }
+}
+
+void UringBackend::close(int fd)
+{
+    auto it = m_sockets.find(fd);
+    if (it == m_sockets.end())
+    {
+        return;
+    }
+
+    std::unique_ptr<Socket> socket = std::move(it->second);
+    m_sockets.erase(it);
+    socket->closed = true;
+
+    // Shutting down ends the multishot recv and fails queued sends. The descriptor
+    // itself stays open until the last op completes, so a linked SEND can never
+    // land on a recycled fd number.
+    shutdown(fd, SHUT_RDWR);
+    if (socket->inflight == 0)
+    {
+        ::close(fd);
+    }
+    else
+    {
+        m_closing.push_back(std::move(socket));
+    }
+}
+
+void UringBackend::finishOp(Socket* socket)
+{
+    if (--socket->inflight > 0 || !socket->closed)
+    {
+        return;
+    }
+
+    auto it = std::find_if(m_closing.begin(), m_closing.end(),
+                           [socket](const std::unique_ptr<Socket>& s) { return s.get() == socket; });
+    if (it != m_closing.end())
+    {
+        ::close(socket->fd);
+        m_closing.erase(it);
+    }
+}
+
+void UringBackend::deleteLater(std::unique_ptr<IoChannel> channel)
+{
+    m_doomed.push_back(std::move(channel));
+}
+
+void UringBackend::post(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_posted.push_back(std::move(task));
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(m_wake_fd, &one, sizeof(one));
+}
+
+void UringBackend::runPosted()
+{
+    // Both lists keep their capacity across the swap, as in EventLoop
+    {
+        std::lock_guard<std::mutex> lock(m_post_mutex);
+        m_running.swap(m_posted);
+    }
+
+    for (auto& task : m_running)
+    {
+        task();
+    }
+    m_running.clear();
+}
+
+void UringBackend::setTick(std::chrono::milliseconds interval, std::function<void(uint64_t ticks)> tick)
+{
+    m_tick = std::move(tick);
+
+    bool first = m_tick_fd < 0;
+    if (first)
+    {
+        m_tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+        if (m_tick_fd < 0)
+        {
+            throw std::runtime_error(std::string("timerfd_create failed: ") + strerror(errno));
+        }
+    }
+
+    itimerspec spec{};
+    spec.it_interval.tv_sec = interval.count() / 1000;
+    spec.it_interval.tv_nsec = (interval.count() % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    timerfd_settime(m_tick_fd, 0, &spec, nullptr);
+
+    if (first)
+    {
+        armTick();
+    }
+}
+
+void UringBackend::run()
+{
+    while (!m_stop_requested.load(std::memory_order_acquire))
+    {
+        bool have_completions = loadAcquire(m_cq_tail) != *m_cq_head;
+        submit(have_completions ? 0 : 1);
+
+        processCompletions();
+
+        if (m_recv_starved)
+        {
+            // Buffers have been recycled by now; restart receives that ran dry
+            m_recv_starved = false;
+            for (auto& [fd, socket] : m_sockets)
+            {
+                if (socket->recv_starved)
+                {
+                    socket->recv_starved = false;
+                    armRecv(socket.get());
+                }
+            }
+        }
+
+        startQueuedSends();
+        m_doomed.clear();
+    }
+}
+
+void UringBackend::processCompletions()
+{
+    unsigned head = *m_cq_head;
+    while (head != loadAcquire(m_cq_tail))
+    {
+        const io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+        uint64_t user_data = cqe.user_data;
+        int32_t res = cqe.res;
+        uint32_t flags = cqe.flags;
+
+        // Hand the slot back before the callback, which may queue more work
+        ++head;
+        storeRelease(m_cq_head, head);
+
+        handleCompletion(user_data, res, flags);
+    }
+}
+
+void UringBackend::handleCompletion(uint64_t user_data, int32_t res, uint32_t flags)
+{
+    uint64_t op = user_data & OpMask;
+    bool more = (flags & IORING_CQE_F_MORE) != 0;
+
+    if (op == OpWake)
+    {
+        runPosted();
+        if (!m_stop_requested.load(std::memory_order_acquire))
+        {
+            armWake();
+        }
+        return;
+    }
+
+    if (op == OpCancel)
+    {
+        return;
+    }
+
+    if (op == OpTick)
+    {
+        // The timerfd counts the expirations since the last read, however late it is
+        if (res > 0 && m_tick && m_tick_expirations > 0)
+        {
+            m_tick(m_tick_expirations);
+        }
+        if (res != -EBADF && res != -EINVAL && !m_stop_requested.load(std::memory_order_acquire))
+        {
+            armTick();
+        }
+        return;
+    }
+
+    if (op == OpAccept)
+    {
+        auto* listener = reinterpret_cast<Listener*>(user_data & ~OpMask);
+        if (res >= 0)
+        {
+            sockaddr_in client_addr{};
+            socklen_t client_len = sizeof(client_addr);
+            char ip[INET_ADDRSTRLEN] = {};
+            if (getpeername(res, reinterpret_cast<sockaddr*>(&client_addr), &client_len) == 0)
+            {
+                inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+            }
+
+            IoChannel* channel = listener->acceptor->onAccept(res, ip);
+            if (channel == nullptr)
+            {
+                ::close(res);
+            }
+            else
+            {
+                auto socket = std::make_unique<Socket>();
+                socket->fd = res;
+                socket->channel = channel;
+                armRecv(socket.get());
+                m_sockets[res] = std::move(socket);
+            }
+        }
+        // -EINVAL/-EBADF mean the listener (or multishot accept) is unusable; don't spin
+        if (!more && !listener->stopped && res != -EINVAL && res != -EBADF &&
+            !m_stop_requested.load(std::memory_order_acquire))
+        {
+            armAccept(listener);
+        }
+        return;
+    }
+
+    if (op == OpSendZc)
+    {
+        // SEND_ZC reports the send, then (flagged F_MORE) a notification once the
+        // kernel no longer needs the memory. Notifications keep the op in flight.
+        auto* send = reinterpret_cast<ZeroCopySend*>(user_data & ~OpMask);
+        Socket* socket = send->socket;
+        if (flags & IORING_CQE_F_NOTIF)
+        {
+            releaseZeroCopy(socket, send);
+        }
+        else
+        {
+            if (more)
+            {
+                ++socket->inflight;
+            }
+            else
+            {
+                releaseZeroCopy(socket, send);
+            }
+            onSendDone(socket, res);
+        }
+        finishOp(socket);
+        return;
+    }
+
+    auto* socket = reinterpret_cast<Socket*>(user_data & ~OpMask);
+
+    if (op == OpRecv)
+    {
+        if (flags & IORING_CQE_F_BUFFER)
+        {
+            uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+            if (res > 0 && !socket->closed)
+            {
+                socket->channel->onReceive(m_buffers.data() + static_cast<size_t>(bid) * RecvBufferSize, res);
+            }
+            recycleBuffer(bid);
+        }
+
+        if (!more)
+        {
+            if (!socket->closed)
+            {
+                if (res == 0)
+                {
+                    socket->channel->onEndOfStream();
+                }
+                else if (res == -ENOBUFS)
+                {
+                    socket->recv_starved = true;
+                    m_recv_starved = true;
+                }
+                else if (res < 0)
+                {
+                    socket->channel->onError(-res);
+                }
+                else
+                {
+                    armRecv(socket);  // Multishot ended early (e.g. CQ overflow)
+                }
+            }
+            finishOp(socket);
+        }
+        return;
+    }
+
+    // READ+SEND pairs report twice; act once both halves are back
+    if (socket->link_outstanding > 0)
+    {
+        if (op == OpFileRead)
+        {
+            socket->link_read_result = res;
+        }
+        else
+        {
+            socket->link_send_result = res;
+        }
+        if (--socket->link_outstanding == 0)
+        {
+            onSendDone(socket, socket->link_send_result);
+        }
+    }
+    else
+    {
+        onSendDone(socket, res);
+    }
+    finishOp(socket);
+}
+
+// Notifications mostly come back in send order, so the search rarely goes past the front.
+void UringBackend::releaseZeroCopy(Socket* socket, const ZeroCopySend* send)
+{
+    auto it = std::find_if(socket->zerocopy_sends.begin(), socket->zerocopy_sends.end(),
+                           [send](const ZeroCopySend& s) { return &s == send; });
+    socket->zerocopy_sends.erase(it);
+}
+
+void UringBackend::stop()
+{
+    m_stop_requested.store(true, std::memory_order_release);
+    uint64_t one = 1;
+    [[maybe_unused]] ssize_t n = write(m_wake_fd, &one, sizeof(one));
+}
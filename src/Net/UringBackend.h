@@ -0,0 +1,127 @@
+#pragma once
+
+#include "IoBackend.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+// Completion-based backend on io_uring (Linux 6.0+): multishot accept, multishot
+// recv into a provided buffer ring, linked read+send pairs for file bodies, and
+// SEND_ZC for zero-copy output.
+// Talks to the kernel directly, so there is no liburing dependency.
+// The constructor throws when the ring or any feature it relies on is unavailable.
+class UringBackend : public IoBackend
+{
+public:
+    explicit UringBackend(unsigned queue_depth = 4096);
+    ~UringBackend() override;
+
+    UringBackend(const UringBackend&) = delete;
+    UringBackend& operator=(const UringBackend&) = delete;
+
+    const char* name() const override { return "io_uring"; }
+
+    void listen(int listen_fd, bool exclusive, IoAcceptor* acceptor) override;
+    void stopListening() override;
+    void send(int fd, const char* data, size_t length) override;
+    void sendFile(int fd, int file_fd, uint64_t offset, uint64_t length) override;
+    void sendZeroCopy(int fd, const char* data, size_t length, std::shared_ptr<const void> owner) override;
+    void close(int fd) override;
+    void deleteLater(std::unique_ptr<IoChannel> channel) override;
+    void post(std::function<void()> task) override;
+    void setTick(std::chrono::milliseconds interval, std::function<void(uint64_t ticks)> tick) override;
+    void run() override;
+    void stop() override;
+
+private:
+    // Stored in the low bits of user_data; the rest is the Listener/Socket pointer,
+    // or for OpSendZc the ZeroCopySend the op belongs to.
+    enum Op : uint64_t
+    {
+        OpAccept = 0,
+        OpRecv = 1,
+        OpSend = 2,
+        OpFileRead = 3,
+        OpWake = 4,
+        OpTick = 5,
+        OpCancel = 6,
+        OpSendZc = 7,
+    };
+    static constexpr uint64_t OpMask = 7;
+
+    struct Listener;
+    struct ZeroCopySend;
+    struct Socket;
+
+    int m_ring_fd = -1;
+
+    // Submission queue
+    void* m_sq_ring = nullptr;
+    size_t m_sq_ring_size = 0;
+    unsigned* m_sq_head = nullptr;
+    unsigned* m_sq_tail = nullptr;
+    unsigned* m_sq_array = nullptr;
+    unsigned m_sq_mask = 0;
+    unsigned m_sq_entries = 0;
+    unsigned m_sq_local_tail = 0;
+    unsigned m_unsubmitted = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqes_size = 0;
+
+    // Completion queue (shares the SQ mapping on every kernel we accept)
+    unsigned* m_cq_head = nullptr;
+    unsigned* m_cq_tail = nullptr;
+    unsigned m_cq_mask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+
+    // Provided buffers for multishot recv
+    io_uring_buf_ring* m_buf_ring = nullptr;
+    size_t m_buf_ring_size = 0;
+    std::vector<char> m_buffers;
+    uint16_t m_buf_tail = 0;
+    bool m_recv_starved = false;
+
+    int m_wake_fd = -1;
+    uint64_t m_wake_value = 0;
+    int m_tick_fd = -1;
+    uint64_t m_tick_expirations = 0;
+    std::function<void(uint64_t)> m_tick;
+
+    std::atomic<bool> m_stop_requested{false};
+    std::mutex m_post_mutex;
+    std::vector<std::function<void()>> m_posted;
+    std::vector<std::function<void()>> m_running;   // m_posted, while it runs
+
+    std::vector<std::unique_ptr<Listener>> m_listeners;
+    std::unordered_map<int, std::unique_ptr<Socket>> m_sockets;
+    std::vector<std::unique_ptr<Socket>> m_closing;     // Waiting for in-flight ops
+    std::vector<std::unique_ptr<IoChannel>> m_doomed;   // Deleted after the batch
+    std::vector<int> m_send_ready;                      // Output queued this batch
+    std::vector<int> m_send_starting;                   // m_send_ready, while it's started
+
+    io_uring_sqe* nextSqe();
+    void submit(unsigned wait_for);
+    void processCompletions();
+    void handleCompletion(uint64_t user_data, int32_t res, uint32_t flags);
+
+    void armAccept(Listener* listener);
+    void armRecv(Socket* socket);
+    void armWake();
+    void armTick();
+    void queueSend(Socket* socket);
+    void startQueuedSends();
+    void startSend(Socket* socket);
+    void onSendDone(Socket* socket, int32_t res);
+    void releaseZeroCopy(Socket* socket, const ZeroCopySend* send);
+    void recycleBuffer(uint16_t bid);
+    void finishOp(Socket* socket);
+    void runPosted();
+    void teardown();
+};
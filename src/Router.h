@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum class HttpMethod : uint8_t { Other, Get, Head, Post, Put, Delete, Options };
+
+constexpr HttpMethod httpMethod(std::string_view method) {
+    if (method == "GET") return HttpMethod::Get;
+    if (method == "HEAD") return HttpMethod::Head;
+    if (method == "POST") return HttpMethod::Post;
+    if (method == "PUT") return HttpMethod::Put;
+    if (method == "DELETE") return HttpMethod::Delete;
+    if (method == "OPTIONS") return HttpMethod::Options;
+    return HttpMethod::Other;
+}
+
+template <typename Handler>
+struct Route {
+    HttpMethod method;
+    std::string_view path;
+    Handler handler;
+};
+
+// Route table laid out at compile time as a perfect hash over (method, path): every
+// route owns a slot of its own, so find() hashes the path once and makes a single
+// comparison however many routes there are. Building it searches for a seed that
+// separates all routes; duplicate routes fail to compile.
+template <typename Handler, size_t N>
+class RouteTable
+{
+public:
+    consteval explicit RouteTable(const Route<Handler> (&routes)[N]) {
+        std::array<uint32_t, N> keys{};
+        for (size_t i = 0; i < N; ++i) {
+            keys[i] = baseHash(routes[i].method, routes[i].path);
+            for (size_t j = 0; j < i; ++j) {
+                if (keys[j] == keys[i]) {
+                    throw "duplicate route, or two routes whose hashes collide";
+                }
+            }
+        }
+
+        for (seed = 0; !place(routes, keys); ++seed) {
+        }
+    }
+
+    constexpr const Handler* find(HttpMethod method, std::string_view path) const {
+        const Slot& slot = slots[slotFor(baseHash(method, path))];
+        if (slot.used && slot.method == method && slot.path == path) {
+            return &slot.handler;
+        }
+        return nullptr;
+    }
+
+private:
+    // Four slots per route keeps the seed search short even for large tables.
+    static constexpr size_t Size = std::bit_ceil(N * 4);
+
+    struct Slot {
+        bool used = false;
+        HttpMethod method = HttpMethod::Other;
+        std::string_view path;
+        Handler handler{};
+    };
+
+    std::array<Slot, Size> slots{};
+    uint32_t seed = 0;
+
+    // FNV-1a over method and path
+    static constexpr uint32_t baseHash(HttpMethod method, std::string_view path) {
+        uint32_t hash = (2166136261u ^ static_cast<uint8_t>(method)) * 16777619u;
+        for (char c : path) {
+            hash = (hash ^ static_cast<uint8_t>(c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    // Re-mixes the path's hash with the seed (murmur3 finaliser), so trying another
+    // seed doesn't rehash any paths.
+    constexpr size_t slotFor(uint32_t key) const {
+        uint32_t hash = key ^ (seed * 0x9e3779b9u);
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bu;
+        hash ^= hash >> 13;
+        hash *= 0xc2b2ae35u;
+        hash ^= hash >> 16;
+        return hash & (Size - 1);
+    }
+
+    consteval bool place(const Route<Handler> (&routes)[N], const std::array<uint32_t, N>& keys) {
+        slots = {};
+        for (size_t i = 0; i < N; ++i) {
+            Slot& slot = slots[slotFor(keys[i])];
+            if (slot.used) {
+                return false;
+            }
+            slot = Slot{ true, routes[i].method, routes[i].path, routes[i].handler };
+        }
+        return true;
+    }
+};
@@ -7,17 +7,48 @@
 #include <sstream>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <regex>
 #include <chrono>
 #include <iomanip>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <algorithm>
+#include <charconv>
+#include <coroutine>
+#include <optional>
+#include <cstring>
+#include <random>
 #include <json/json.h>  // You'll need jsoncpp library
 
 // Socket includes (Unix/Linux)
-//#include <sys/socket.h>
-//#include <netinet/in.h>
-//#include <unistd.h>
-//#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/openat2.h>
+#include <arpa/inet.h>
+#include "Arena.h"
+#include "Compression.h"
+#include "Config.h"
+#include "HttpConditional.h"
+#include "HttpDate.h"
+#include "HttpHeaders.h"
+#include "HttpRange.h"
+#include "HttpRequest.h"
+#include "HttpScan.h"
+#include "Metrics.h"
+#include "ThreadPool.h"
+#include "Net/IoBackend.h"
+#include "Net/Task.h"
+#include "Net/TimerWheel.h"
+#include "Router.h"
 #include "Socket/SocketStream.h"
+#include "Socket/SocketType.h"
 
 namespace fs = std::filesystem;
 
@@ -52,140 +83,116 @@ public:
     void info(const std::string& msg) { log("INFO", msg); }
     void error(const std::string& msg) { log("ERROR", msg); }
     void warning(const std::string& msg) { log("WARN", msg); }
-};
 
-class HttpRequest {
-public:
-    std::string method;
-    std::string path;
-    std::string query_string;
-    std::map<std::string, std::string> headers;
-    std::vector<uint8_t> body;
-    std::string client_ip;
-
-    static HttpRequest parse(const std::string& raw_request, const std::string& client_ip = "") {
-        HttpRequest req;
-        req.client_ip = client_ip;
-        std::istringstream stream(raw_request);
-        std::string line;
-
-        // Parse request line
-        if (std::getline(stream, line)) {
-            std::istringstream request_line(line);
-            std::string full_path;
-            request_line >> req.method >> full_path;
-
-            // Split path and query string
-            size_t query_pos = full_path.find('?');
-            if (query_pos != std::string::npos) {
-                req.path = full_path.substr(0, query_pos);
-                req.query_string = full_path.substr(query_pos + 1);
-            }
-            else {
-                req.path = full_path;
-            }
-        }
+    // For hot paths, to skip building a message nobody will see.
+    bool isEnabled() const { return enabled; }
 
-        // Parse headers
-        while (std::getline(stream, line) && line != "\r") {
-            size_t colon = line.find(':');
-            if (colon != std::string::npos) {
-                std::string key = line.substr(0, colon);
-                std::string value = line.substr(colon + 2);
-                if (!value.empty() && value.back() == '\r') {
-                    value.pop_back();
-                }
-                req.headers[key] = value;
-            }
-        }
-
-        // Read body if Content-Length is specified
-        auto content_length_it = req.headers.find("Content-Length");
-        if (content_length_it != req.headers.end()) {
-            int content_length = std::stoi(content_length_it->second);
-            std::string remaining_data((std::istreambuf_iterator<char>(stream)),
-                std::istreambuf_iterator<char>());
-            req.body = std::vector<uint8_t>(remaining_data.begin(), remaining_data.end());
+    void flush() {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        if (log_file.is_open()) {
+            log_file.flush();
         }
-
-        return req;
+        std::cout.flush();
     }
+};
 
-    std::map<std::string, std::string> parseQuery() const {
-        std::map<std::string, std::string> params;
-        std::istringstream stream(query_string);
-        std::string pair;
+// Response body streamed straight from an open file; closed with the last reference.
+struct FileBody {
+    int fd;
+    uint64_t offset;
+    uint64_t length;
+    std::time_t modified = 0;
+    std::string etag;
+
+    FileBody(int file_fd, uint64_t off, uint64_t len) : fd(file_fd), offset(off), length(len) {}
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+    ~FileBody() { close(fd); }
+};
 
-        while (std::getline(stream, pair, '&')) {
-            size_t equals = pair.find('=');
-            if (equals != std::string::npos) {
-                params[pair.substr(0, equals)] = urlDecode(pair.substr(equals + 1));
-            }
-        }
-        return params;
-    }
+// One part of a multipart/byteranges body: the part's delimiter and headers, then a
+// range of the response's file.
+struct FilePart {
+    std::string head;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+};
 
-private:
-    std::string urlDecode(const std::string& str) const {
-        std::string result;
-        for (size_t i = 0; i < str.length(); ++i) {
-            if (str[i] == '%' && i + 2 < str.length()) {
-                int value = std::stoi(str.substr(i + 1, 2), nullptr, 16);
-                result += static_cast<char>(value);
-                i += 2;
-            }
-            else if (str[i] == '+') {
-                result += ' ';
-            }
-            else {
-                result += str[i];
-            }
-        }
-        return result;
-    }
+// A response body produced piece by piece and sent with chunked transfer coding as
+// each piece is ready, for output too large or slow to build up front. next() runs on
+// the handler pool, so it may block on disk.
+class BodyStream {
+public:
+    virtual ~BodyStream() = default;
+
+    // Appends the next piece to out; false once the body is complete.
+    virtual bool next(std::string& out) = 0;
 };
 
+// Immutable bytes that many responses may be sending at once, e.g. a cached asset.
+using SharedBody = std::shared_ptr<const std::vector<uint8_t>>;
+
 class HttpResponse {
 public:
     int status_code = 200;
-    std::map<std::string, std::string> headers;
-    std::vector<uint8_t> body;
+    HeaderList<HeaderValue> headers;
+    std::pmr::vector<uint8_t> body{ Arena::current() };
+    SharedBody shared_body;               // Sent after the headers instead of body
+    std::shared_ptr<FileBody> file_body;  // Sent after the headers instead of body
+    std::vector<FilePart> file_parts;     // If set, sent instead of file_body's range
+    std::shared_ptr<BodyStream> stream;   // Sent chunked after the headers instead of body
+    bool head_only = false;               // Answer to HEAD: the headers GET would get, no body
 
     HttpResponse() {
         // Default security headers
-        headers["X-Frame-Options"] = "DENY";
-        headers["X-Content-Type-Options"] = "nosniff";
-        headers["X-XSS-Protection"] = "1; mode=block";
+        headers.set(HeaderId::XFrameOptions, "DENY");
+        headers.set(HeaderId::XContentTypeOptions, "nosniff");
+        headers.set(HeaderId::XXssProtection, "1; mode=block");
     }
 
-    std::string serialize() const {
-        std::ostringstream response;
+    // Status line and headers only. The body goes out from where it lies, gathered
+    // with the head into the same sendmsg() by the I/O backend.
+    std::pmr::string serializeHead(std::pmr::memory_resource* resource) const {
+        std::pmr::string response(resource);
+        response.reserve(512);
 
         // Status line
-        response << "HTTP/1.1 " << status_code << " " << getStatusText() << "\r\n";
+        response += "HTTP/1.1 ";
+        char number[24];
+        response.append(number, std::to_chars(number, number + sizeof(number), status_code).ptr);
+        response += ' ';
+        response += getStatusText();
+        response += "\r\n";
 
         // Headers
-        auto headers_copy = headers;
-        headers_copy["Content-Length"] = std::to_string(body.size());
-        headers_copy["Server"] = "RaspberryPi-FileServer/1.0";
-
-        for (const auto& [key, value] : headers_copy) {
-            response << key << ": " << value << "\r\n";
+        for (const auto& header : headers) {
+            if (header.id == HeaderId::ContentLength || header.id == HeaderId::TransferEncoding ||
+                    header.id == HeaderId::Server) {
+                continue;
+            }
+            response += header.name;
+            response += ": ";
+            response += header.value.view();
+            response += "\r\n";
         }
-        response << "\r\n";
-
-        std::string header_str = response.str();
-        std::vector<uint8_t> full_response(header_str.begin(), header_str.end());
-        full_response.insert(full_response.end(), body.begin(), body.end());
-
-        return std::string(full_response.begin(), full_response.end());
+        if (stream) {
+            response += "Transfer-Encoding: chunked\r\n";
+        }
+        else if (status_code != 204 && status_code != 304) {
+            // Those two never have a body, and mustn't claim one of length 0
+            response += "Content-Length: ";
+            response.append(number, std::to_chars(number, number + sizeof(number), contentLength()).ptr);
+            response += "\r\n";
+        }
+        response += "Server: RaspberryPi-FileServer/1.0\r\n\r\n";
+        return response;
     }
 
     void setJson(const Json::Value& json) {
         Json::StreamWriterBuilder builder;
         std::string json_str = Json::writeString(builder, json);
-        body = std::vector<uint8_t>(json_str.begin(), json_str.end());
-        headers["Content-Type"] = "application/json";
+        body.assign(json_str.begin(), json_str.end());
+        headers.set(HeaderId::ContentType, "application/json");
     }
 
     void setError(int code, const std::string& message) {
@@ -197,11 +204,27 @@ public:
     }
 
 private:
-    std::string getStatusText() const {
+    uint64_t contentLength() const {
+        if (!file_parts.empty()) {
+            uint64_t length = 0;
+            for (const FilePart& part : file_parts) {
+                length += part.head.size() + part.length;
+            }
+            return length;
+        }
+        if (file_body) {
+            return file_body->length;
+        }
+        return shared_body ? shared_body->size() : body.size();
+    }
+
+    std::string_view getStatusText() const {
         switch (status_code) {
         case 200: return "OK";
         case 201: return "Created";
         case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
         case 400: return "Bad Request";
         case 401: return "Unauthorized";
         case 403: return "Forbidden";
@@ -209,7 +232,10 @@ private:
         case 405: return "Method Not Allowed";
         case 409: return "Conflict";
         case 413: return "Payload Too Large";
+        case 416: return "Range Not Satisfiable";
         case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
         default: return "Unknown";
         }
     }
@@ -218,8 +244,11 @@ private:
 class FileManager {
 private:
     std::string root_directory;
-    std::mutex file_mutex;
+    std::mutex file_mutex;  // Serializes writes and deletes; reads never take it
     Logger& logger;
+    std::atomic<uint64_t> generation{ 0 };  // Bumped by every write and delete made here
+    fs::path canonical_root;
+    int root_fd = -1;       // Paths from requests are opened relative to this
 
 public:
     struct FileInfo {
@@ -243,66 +272,107 @@ public:
         }
     };
 
+    // A directory found to lie under the root, with the stat() taken while checking.
+    struct Directory {
+        std::string full_path;
+        struct stat st;
+    };
+
     FileManager(const std::string& root, Logger& log) : root_directory(root), logger(log) {
         fs::create_directories(root);
+        canonical_root = fs::canonical(fs::absolute(root));
+        root_fd = open(root.c_str(), O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (root_fd < 0) {
+            throw std::runtime_error("Cannot open root directory " + root + ": " + std::strerror(errno));
+        }
         logger.info("FileManager initialized with root: " + root);
     }
 
-    std::vector<FileInfo> listDirectory(const std::string& relative_path = "") {
-        std::lock_guard<std::mutex> lock(file_mutex);
-        std::vector<FileInfo> files;
+    ~FileManager() {
+        close(root_fd);
+    }
 
-        std::string full_path = root_directory + "/" + relative_path;
-        if (!isPathSafe(full_path)) {
-            logger.warning("Unsafe path access attempt: " + relative_path);
-            return files;
+    // Checks the path and stats the directory in one go: an openat2() and an fstat().
+    std::optional<Directory> findDirectory(const std::string& relative_path) {
+        int fd = openBeneath(relative_path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EXDEV) {
+                logger.warning("Unsafe path access attempt: " + relative_path);
+            }
+            return std::nullopt;
         }
 
-        try {
-            for (const auto& entry : fs::directory_iterator(full_path)) {
-                FileInfo info;
-                info.name = entry.path().filename().string();
-                info.path = relative_path + (relative_path.empty() ? "" : "/") + info.name;
-                info.is_directory = entry.is_directory();
-                info.size = entry.is_directory() ? 0 : entry.file_size();
-                info.mime_type = getMimeType(info.name);
-
-                auto time = fs::last_write_time(entry);
-                auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                    time - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
-                std::time_t tt = std::chrono::system_clock::to_time_t(sctp);
-                std::ostringstream oss;
-                oss << std::put_time(std::localtime(&tt), "%Y-%m-%d %H:%M:%S");
-                info.modified = oss.str();
-
-                files.push_back(info);
-            }
+        Directory directory{ root_directory + "/" + relative_path, {} };
+        bool found = fstat(fd, &directory.st) == 0;
+        close(fd);
+        if (!found) {
+            return std::nullopt;
         }
-        catch (const std::exception& e) {
-            logger.error("Error listing directory: " + std::string(e.what()));
+        return directory;
+    }
+
+    // Starts walking a directory found by findDirectory(); false if it can't be listed.
+    bool openDirectory(const Directory& directory, fs::directory_iterator& it) {
+        std::error_code error;
+        it = fs::directory_iterator(directory.full_path, error);
+        if (error) {
+            logger.error("Error listing directory: " + error.message());
+            return false;
         }
+        return true;
+    }
 
-        return files;
+    // Weak ETag for a directory's listing, from the stat() findDirectory() took: its
+    // mtime moves when entries are added, removed or renamed, and the generation
+    // when a file is rewritten through this server. Files edited in place by other
+    // processes go unnoticed until the directory itself changes.
+    std::string directoryVersion(const Directory& directory, std::string_view format) const {
+        std::string suffix = std::to_string(generation.load(std::memory_order_relaxed));
+        suffix += '-';
+        suffix += format;
+        return "W/" + fileETag(directory.st, suffix);
     }
 
-    std::vector<uint8_t> readFile(const std::string& relative_path) {
-        std::lock_guard<std::mutex> lock(file_mutex);
-        std::string full_path = root_directory + "/" + relative_path;
+    FileInfo fileInfo(const fs::directory_entry& entry, const std::string& relative_path) const {
+        FileInfo info;
+        info.name = entry.path().filename().string();
+        info.path = relative_path + (relative_path.empty() ? "" : "/") + info.name;
+        info.is_directory = entry.is_directory();
+        info.size = entry.is_directory() ? 0 : entry.file_size();
+        info.mime_type = getMimeType(info.name);
+
+        auto time = fs::last_write_time(entry);
+        auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+            time - fs::file_time_type::clock::now() + std::chrono::system_clock::now());
+        std::time_t tt = std::chrono::system_clock::to_time_t(sctp);
+        std::ostringstream oss;
+        oss << std::put_time(std::localtime(&tt), "%Y-%m-%d %H:%M:%S");
+        info.modified = oss.str();
+        return info;
+    }
 
-        if (!isPathSafe(full_path)) {
+    // Opens a file for streaming; the I/O backend reads it while sending. The path
+    // check is the open itself, so validating a download costs an open and an fstat().
+    std::shared_ptr<FileBody> openFile(const std::string& relative_path) {
+        int fd = openBeneath(relative_path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0 && errno == EXDEV) {
             logger.warning("Unsafe file read attempt: " + relative_path);
-            return {};
+            return nullptr;
         }
 
-        std::ifstream file(full_path, std::ios::binary);
-        if (!file) {
+        struct stat st{};
+        if (fd < 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+            if (fd >= 0) {
+                close(fd);
+            }
             logger.warning("File not found: " + relative_path);
-            return {};
+            return nullptr;
         }
 
-        logger.info("File downloaded: " + relative_path);
-        return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>());
+        auto body = std::make_shared<FileBody>(fd, 0, static_cast<uint64_t>(st.st_size));
+        body->modified = st.st_mtim.tv_sec;
+        body->etag = fileETag(st);
+        return body;
     }
 
     bool writeFile(const std::string& relative_path, const std::vector<uint8_t>& data) {
@@ -328,6 +398,7 @@ public:
 
         if (success) {
             logger.info("File uploaded: " + relative_path + " (" + std::to_string(data.size()) + " bytes)");
+            generation.fetch_add(1, std::memory_order_relaxed);
         }
         else {
             logger.error("Failed to write file: " + relative_path);
@@ -349,6 +420,7 @@ public:
 
         if (success) {
             logger.info("File deleted: " + relative_path);
+            generation.fetch_add(1, std::memory_order_relaxed);
         }
         else {
             logger.warning("Failed to delete file: " + relative_path);
@@ -357,41 +429,77 @@ public:
         return success;
     }
 
-    Json::Value getStats() {
-        std::lock_guard<std::mutex> lock(file_mutex);
+    // Each subdirectory is walked as its own subtask so idle pool threads can steal
+    // parts of a large tree instead of one handler walking it end to end.
+    Json::Value getStats(ThreadPool& pool) {
         Json::Value stats;
 
-        uint64_t total_size = 0;
-        int file_count = 0;
-        int folder_count = 0;
-
-        try {
-            for (const auto& entry : fs::recursive_directory_iterator(root_directory)) {
-                if (entry.is_directory()) {
-                    folder_count++;
-                }
-                else {
-                    file_count++;
-                    total_size += entry.file_size();
+        std::atomic<uint64_t> total_size{ 0 };
+        std::atomic<int> file_count{ 0 };
+        std::atomic<int> folder_count{ 0 };
+
+        TaskGroup group(pool);
+        std::function<void(const fs::path&)> walk = [&](const fs::path& dir) {
+            try {
+                uint64_t dir_size = 0;
+                int dir_files = 0;
+                for (const auto& entry : fs::directory_iterator(dir)) {
+                    if (entry.is_directory()) {
+                        folder_count++;
+                        if (!entry.is_symlink()) {
+                            group.spawn([&walk, path = entry.path()] { walk(path); });
+                        }
+                    }
+                    else {
+                        dir_files++;
+                        dir_size += entry.file_size();
+                    }
                 }
+                file_count += dir_files;
+                total_size += dir_size;
             }
-        }
-        catch (const std::exception& e) {
-            logger.error("Error calculating stats: " + std::string(e.what()));
-        }
+            catch (const std::exception& e) {
+                logger.error("Error calculating stats: " + std::string(e.what()));
+            }
+        };
 
-        stats["total_files"] = file_count;
-        stats["total_folders"] = folder_count;
-        stats["total_size"] = static_cast<Json::UInt64>(total_size);
-        stats["total_size_formatted"] = formatFileSize(total_size);
+        walk(root_directory);
+        group.wait();
+
+        stats["total_files"] = file_count.load();
+        stats["total_folders"] = folder_count.load();
+        stats["total_size"] = static_cast<Json::UInt64>(total_size.load());
+        stats["total_size_formatted"] = formatFileSize(total_size.load());
 
         return stats;
     }
 
 private:
+    // Opens a path under the root in one call: openat2() with RESOLVE_BENEATH fails
+    // with EXDEV for anything that would leave it, through ".." or a symlink alike.
+    // Kernels before 5.6 lack openat2() and get the canonical-path check instead.
+    int openBeneath(const std::string& relative_path, int flags) const {
+        size_t start = relative_path.find_first_not_of('/');
+        std::string relative = start == std::string::npos ? "." : relative_path.substr(start);
+
+        open_how how{};
+        how.flags = static_cast<uint64_t>(flags);
+        how.resolve = RESOLVE_BENEATH;
+        int fd = static_cast<int>(syscall(SYS_openat2, root_fd, relative.c_str(), &how, sizeof(how)));
+        if (fd >= 0 || errno != ENOSYS) {
+            return fd;
+        }
+
+        std::string full_path = root_directory + "/" + relative;
+        if (!isPathSafe(full_path)) {
+            errno = EXDEV;
+            return -1;
+        }
+        return open(full_path.c_str(), flags);
+    }
+
     bool isPathSafe(const std::string& path) const {
         try {
-            fs::path canonical_root = fs::canonical(fs::absolute(root_directory));
             fs::path canonical_path = fs::canonical(fs::absolute(path));
 
             auto rel = fs::relative(canonical_path, canonical_root);
@@ -435,41 +543,345 @@ private:
     }
 };
 
+// /api/files as the directory is read: a JSON array, or NDJSON with one entry per
+// line, a few hundred entries per chunk so the first ones leave before the walk ends.
+class DirectoryListing : public BodyStream {
+private:
+    static constexpr size_t EntriesPerChunk = 256;
+
+    FileManager& file_manager;
+    std::string relative_path;
+    fs::directory_iterator it;
+    bool ndjson;
+    bool started = false;
+    bool finished = false;
+    size_t entries = 0;
+    std::unique_ptr<Json::StreamWriter> writer;
+
+public:
+    DirectoryListing(FileManager& manager, std::string path, fs::directory_iterator entries_it, bool as_ndjson)
+        : file_manager(manager), relative_path(std::move(path)), it(std::move(entries_it)), ndjson(as_ndjson) {
+        Json::StreamWriterBuilder builder;
+        builder["indentation"] = "";
+        writer.reset(builder.newStreamWriter());
+    }
+
+    bool next(std::string& out) override {
+        if (finished) {
+            return false;
+        }
+
+        std::ostringstream chunk;
+        if (!started && !ndjson) {
+            chunk << '[';
+        }
+        started = true;
+
+        std::error_code error;
+        for (size_t count = 0; it != fs::directory_iterator() && count < EntriesPerChunk; it.increment(error)) {
+            Json::Value entry;
+            try {
+                entry = file_manager.fileInfo(*it, relative_path).toJson();
+            }
+            catch (const fs::filesystem_error&) {
+                continue;   // Removed while we were listing
+            }
+            if (entries++ > 0 && !ndjson) {
+                chunk << ',';
+            }
+            writer->write(entry, &chunk);
+            if (ndjson) {
+                chunk << '\n';
+            }
+            ++count;
+        }
+
+        if (error || it == fs::directory_iterator()) {
+            if (!ndjson) {
+                chunk << ']';
+            }
+            finished = true;
+        }
+        out += chunk.str();
+        return true;
+    }
+};
+
+// Another stream's body, compressed as it goes. Every piece is flushed, so the
+// client can decode what it has while the rest is still being produced.
+class CompressedStream : public BodyStream {
+private:
+    std::shared_ptr<BodyStream> source;
+    Deflater::Handle deflater;
+    Metrics& metrics;
+    std::string piece;
+
+public:
+    CompressedStream(std::shared_ptr<BodyStream> inner, ContentCoding coding, int level, Metrics& counters)
+        : source(std::move(inner)), deflater(Deflater::acquire(coding, level)), metrics(counters) {}
+
+    bool next(std::string& out) override {
+        piece.clear();
+        bool more = source->next(piece);
+        if (piece.empty() && more) {
+            return true;
+        }
+
+        auto started = std::chrono::steady_clock::now();
+        size_t before = out.size();
+        deflater->compress(piece.data(), piece.size(), !more, out);
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+        metrics.recordCompression(piece.size(), out.size() - before, static_cast<uint64_t>(elapsed.count()));
+
+        if (!more) {
+            deflater.reset();
+        }
+        return more;
+    }
+};
+
 class StaticFileServer {
 private:
+    // A file as stat() saw it when it was read; anything different means reload.
+    struct FileStamp {
+        timespec modified{};
+        off_t size = -1;        // -1: there was no such file
+
+        bool operator==(const FileStamp& other) const {
+            return size == other.size && modified.tv_sec == other.modified.tv_sec &&
+                modified.tv_nsec == other.modified.tv_nsec;
+        }
+    };
+
+    // One representation of an asset. The ETag names it, and changes with the file.
+    struct Variant {
+        SharedBody body;    // Null if there is no such variant
+        std::string etag;
+    };
+
+    // Assets are read once and served from memory after that, shared by every
+    // response sending them, until the file or a sidecar on disk changes. Compressed
+    // variants come from .zst and .gz files shipped next to the asset, or for gzip
+    // are built when the asset is loaded, so serving them costs no CPU.
+    struct CachedAsset {
+        Variant identity;
+        Variant gzip;       // Absent if compressing doesn't make it smaller
+        Variant zstd;       // Only ever from a sidecar file
+        FileStamp stamp;
+        FileStamp gzip_stamp;
+        FileStamp zstd_stamp;
+        size_t bytes = 0;   // All variants together, counted against the cache budget
+    };
+
+    using AssetPtr = std::shared_ptr<const CachedAsset>;
+
+    // The web directory is expected to fit; past either limit, entries are evicted
+    // in no particular order.
+    static constexpr size_t MaxCachedAssets = 512;
+    static constexpr size_t MaxCachedBytes = 64 * 1024 * 1024;
+
     std::string web_directory;
     Logger& logger;
+    bool compress_assets;
+    std::mutex cache_mutex;
+    std::unordered_map<std::string, AssetPtr> cache;
+    size_t cached_bytes = 0;
 
 public:
-    StaticFileServer(const std::string& web_dir, Logger& log)
-        : web_directory(web_dir), logger(log) {}
+    StaticFileServer(const std::string& web_dir, Logger& log, bool compress)
+        : web_directory(web_dir), logger(log), compress_assets(compress) {
+        preload();
+    }
 
-    HttpResponse serveFile(const std::string& path) {
+    // Validated against the cached copy's ETag and modification time, so a 304
+    // costs the stat() calls that check the cache and never reads a file.
+    HttpResponse serveFile(const HttpRequest& request) {
         HttpResponse response;
 
-        std::string file_path = web_directory + path;
-        if (path == "/") {
-            file_path += "/index.html";
-        }
-
-        std::ifstream file(file_path, std::ios::binary);
-        if (!file) {
+        std::string path = request.path == "/" ? "/index.html" : std::string(request.path);
+        AssetPtr asset = isInsideRoot(path) ? loadAsset(web_directory + path) : nullptr;
+        if (!asset) {
             response.status_code = 404;
             response.setError(404, "File not found");
             return response;
         }
 
-        std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>());
-
-        response.body = content;
-        response.headers["Content-Type"] = getMimeType(file_path);
-        response.headers["Cache-Control"] = "no-cache";
+        std::string mime_type = getMimeType(path);
+        const Variant* variant = &asset->identity;
+        if (compress_assets && isCompressible(mime_type)) {
+            std::string_view accept_encoding = request.header(HeaderId::AcceptEncoding);
+            response.headers.set(HeaderId::Vary, "Accept-Encoding");
+            if (asset->zstd.body && acceptsCoding(accept_encoding, ContentCoding::Zstd)) {
+                variant = &asset->zstd;
+                response.headers.set(HeaderId::ContentEncoding, "zstd");
+            }
+            else if (asset->gzip.body && acceptsCoding(accept_encoding, ContentCoding::Gzip)) {
+                variant = &asset->gzip;
+                response.headers.set(HeaderId::ContentEncoding, "gzip");
+            }
+        }
+        response.headers.set(HeaderId::ETag, variant->etag);
+        response.headers.set(HeaderId::LastModified, formatHttpDate(asset->stamp.modified.tv_sec));
+        response.headers.set(HeaderId::CacheControl, "no-cache");
+
+        // Sent as identity, the asset may still be compressed on the way out (deflate
+        // has no variant of its own), and the client then holds that copy's tag
+        std::string recoded;
+        if (variant == &asset->identity && compress_assets && isCompressible(mime_type)) {
+            ContentCoding coding = negotiateCoding(request.header(HeaderId::AcceptEncoding));
+            if (coding != ContentCoding::Identity) {
+                recoded = etagVariant(variant->etag, codingName(coding));
+            }
+        }
+        std::string_view current = revalidatedETag(request, variant->etag, recoded);
+        if (isNotModified(request, current, asset->stamp.modified.tv_sec)) {
+            response.headers.set(HeaderId::ETag, std::string(current));
+            response.status_code = 304;
+            return response;
+        }
 
+        response.shared_body = variant->body;
+        response.headers.set(HeaderId::ContentType, mime_type);
         return response;
     }
 
 private:
+    // Request paths are served from under the web directory only: no ".." segment
+    // may climb out of it, so nothing outside ever reaches the cache.
+    static bool isInsideRoot(std::string_view path) {
+        if (!path.starts_with('/') || path.find('\0') != std::string_view::npos) {
+            return false;
+        }
+        while (!path.empty()) {
+            path.remove_prefix(1);
+            std::string_view segment = path.substr(0, path.find('/'));
+            if (segment == "..") {
+                return false;
+            }
+            path.remove_prefix(segment.size());
+        }
+        return true;
+    }
+
+    // Loads every asset up front, so compressed variants are built before the first
+    // request rather than during it.
+    void preload() {
+        std::error_code error;
+        for (fs::recursive_directory_iterator it(web_directory, error), end; !error && it != end; it.increment(error)) {
+            std::string extension = it->path().extension().string();
+            if (it->is_regular_file(error) && extension != ".gz" && extension != ".zst") {
+                loadAsset(web_directory + "/" + it->path().lexically_relative(web_directory).generic_string());
+            }
+        }
+    }
+
+    static FileStamp stampOf(const std::string& file_path) {
+        struct stat st{};
+        if (stat(file_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            return {};
+        }
+        return { st.st_mtim, st.st_size };
+    }
+
+    // Null when there is no such file.
+    AssetPtr loadAsset(const std::string& file_path) {
+        struct stat st{};
+        if (stat(file_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            return nullptr;
+        }
+        FileStamp stamp{ st.st_mtim, st.st_size };
+        bool compressible = compress_assets && isCompressible(getMimeType(file_path));
+
+        {
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            auto it = cache.find(file_path);
+            if (it != cache.end() && it->second->stamp == stamp) {
+                AssetPtr cached = it->second;
+                // Sidecars may be regenerated without touching the asset
+                if (!compressible || (stampOf(file_path + ".gz") == cached->gzip_stamp &&
+                        stampOf(file_path + ".zst") == cached->zstd_stamp)) {
+                    return cached;
+                }
+            }
+        }
+
+        auto asset = std::make_shared<CachedAsset>();
+        asset->identity = { readWhole(file_path, st.st_size), fileETag(st) };
+        asset->stamp = stamp;
+        if (!asset->identity.body) {
+            return nullptr;
+        }
+
+        if (compressible) {
+            asset->zstd = readSidecar(file_path + ".zst", "zst", st, asset->zstd_stamp);
+            asset->gzip = readSidecar(file_path + ".gz", "gz", st, asset->gzip_stamp);
+            if (!asset->gzip.body) {
+                const SharedBody& body = asset->identity.body;
+                auto compressed = std::make_shared<std::vector<uint8_t>>();
+                Deflater::acquire(ContentCoding::Gzip, Z_BEST_COMPRESSION)->compress(body->data(), body->size(), true, *compressed);
+                if (compressed->size() < body->size()) {
+                    asset->gzip = { std::move(compressed), fileETag(st, "gz") };
+                }
+            }
+        }
+        for (const Variant* variant : { &asset->identity, &asset->gzip, &asset->zstd }) {
+            asset->bytes += variant->body ? variant->body->size() : 0;
+        }
+
+        AssetPtr loaded = std::move(asset);
+        store(file_path, loaded);
+        return loaded;
+    }
+
+    // Assets too big for the whole budget are served without being kept.
+    void store(const std::string& file_path, const AssetPtr& asset) {
+        if (asset->bytes > MaxCachedBytes) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = cache.find(file_path);
+        if (it != cache.end()) {
+            cached_bytes -= it->second->bytes;
+            cache.erase(it);
+        }
+        while (!cache.empty() && (cache.size() >= MaxCachedAssets || cached_bytes + asset->bytes > MaxCachedBytes)) {
+            cached_bytes -= cache.begin()->second->bytes;
+            cache.erase(cache.begin());
+        }
+        cache.emplace(file_path, asset);
+        cached_bytes += asset->bytes;
+    }
+
+    static SharedBody readWhole(const std::string& file_path, off_t size) {
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) {
+            return nullptr;
+        }
+        auto contents = std::make_shared<std::vector<uint8_t>>(static_cast<size_t>(size));
+        file.read(reinterpret_cast<char*>(contents->data()), size);
+        contents->resize(static_cast<size_t>(file.gcount()));
+        return contents;
+    }
+
+    // A precompressed copy of an asset, tagged after the sidecar file itself, unless
+    // it is missing or older than the asset (left over from an earlier deploy).
+    // stamp records the sidecar as found, so a regenerated one is noticed.
+    Variant readSidecar(const std::string& sidecar_path, std::string_view suffix, const struct stat& asset,
+            FileStamp& stamp) {
+        struct stat st{};
+        if (stat(sidecar_path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+            return {};
+        }
+        stamp = { st.st_mtim, st.st_size };
+        if (st.st_mtim.tv_sec < asset.st_mtim.tv_sec ||
+                (st.st_mtim.tv_sec == asset.st_mtim.tv_sec && st.st_mtim.tv_nsec < asset.st_mtim.tv_nsec)) {
+            logger.warning("Ignoring stale " + sidecar_path);
+            return {};
+        }
+        return { readWhole(sidecar_path, st.st_size), fileETag(st, suffix) };
+    }
+
     std::string getMimeType(const std::string& filename) {
         std::string ext = fs::path(filename).extension().string();
         std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
@@ -488,86 +900,923 @@ private:
 class Server {
 private:
     Config config;
-    int server_socket;
+    Logger logger;
     FileManager file_manager;
     StaticFileServer static_server;
-    Logger logger;
-    bool running = false;
+    Metrics metrics;
+    ThreadPool handler_pool;
+    std::atomic<bool> running{ false };
+    std::mutex lifecycle_mutex;     // Orders start() and stop()
+    bool stop_requested = false;
+
+    class Worker;
+
+    // One batch of pipelined requests, their responses and everything built on the way,
+    // allocated from the batch's arena. The handler pool holds a reference while it
+    // works, so a connection closed mid-batch can't pull it out from under a handler;
+    // otherwise the connection reuses the same batch, arena and buffers throughout.
+    struct Batch {
+        Arena arena;
+        std::vector<char> input;    // The requests' bytes; a vector, so swapping keeps them in place
+        std::pmr::vector<HttpRequest> requests{ arena.get() };
+        std::pmr::vector<HttpResponse> responses{ arena.get() };
+        std::pmr::vector<std::pmr::string> wire{ arena.get() };     // Serialized response heads
+        size_t written = 0;     // Responses queued so far; a streamed body holds back the rest
+
+        // The response whose head went out last, if its body is still to be streamed.
+        HttpResponse* streaming() {
+            if (written == 0) {
+                return nullptr;
+            }
+            HttpResponse& last = responses[written - 1];
+            return last.stream && !last.head_only ? &last : nullptr;
+        }
+
+        void clear() {
+            // The vectors must let go of arena memory before the arena forgets it
+            wire = std::pmr::vector<std::pmr::string>(arena.get());
+            responses = std::pmr::vector<HttpResponse>(arena.get());
+            requests = std::pmr::vector<HttpRequest>(arena.get());
+            written = 0;
+            input.clear();
+            arena.reset();
+        }
+    };
+
+    // One accepted client, served by a coroutine: serve() reads a batch of requests,
+    // runs it on the handler pool and writes the responses, suspending on the worker's
+    // event loop in between. The backend callbacks below only buffer input and resume
+    // whichever await is pending.
+    class Connection : public IoChannel {
+    private:
+        enum class State { Reading, Handling, Writing };
+        enum class Timeout { None, Header, Body, Idle, Write };
+
+        Worker& worker;
+        Server& server;
+        int socket_fd;
+        uint64_t connection_id;
+        std::string client_ip;
+        State state = State::Reading;
+        bool peer_closed = false;
+        bool keep_alive = false;        // Decided per request
+        int rejected_status = 0;        // 413 or 400: answer with this, then close
+        int requests_served = 0;
+        bool headers_received = false;  // The partly buffered request has its header block
+        uint64_t request_started;       // Timer ticks: first byte of the current request
+        uint64_t last_activity;         // Timer ticks: last byte received or sent
+        TimerWheel::Timer timeout_timer;
+        // Framed requests keep views into the buffer they arrived in, so its storage is
+        // swapped into the batch whole and only the unparsed tail is copied back.
+        std::vector<char> in_buffer;
+        HttpRequestParser parser;
+        std::shared_ptr<Batch> batch;   // Being framed, handled or written
+        std::string chunk_data;         // Streamed body chunk being written
+        char chunk_head[24];
+        std::coroutine_handle<> waiting;    // serve(), suspended in one of the awaits below
+        Task<> session;
+
+        // co_await read(): the next batch of pipelined requests, or a batch without any
+        // once a request has outgrown max_request_size or failed to parse.
+        struct ReadAwaiter {
+            Connection& connection;
+
+            bool await_ready() { return connection.frameBatch(); }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                connection.state = State::Reading;
+                connection.waiting = handle;
+                connection.armTimeout();
+                if (connection.peer_closed) {
+                    connection.worker.closeConnection(connection.socket_fd);
+                }
+            }
+
+            std::shared_ptr<Batch> await_resume() {
+                connection.state = State::Handling;
+                return connection.batch;
+            }
+        };
+
+        // co_await write(): resumes once the backend has sent the batch's responses, up to
+        // and including the head of the first with a streamed body.
+        struct WriteAwaiter {
+            Connection& connection;
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                connection.waiting = handle;
+                connection.queueResponses();
+            }
+
+            void await_resume() const {}
+        };
+
+        // co_await writeChunk(data, last): sends data as one chunk of a streamed body,
+        // followed by the last-chunk if last.
+        struct ChunkAwaiter {
+            Connection& connection;
+            bool last;
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                connection.waiting = handle;
+                connection.queueChunk(last);
+            }
+
+            void await_resume() const {}
+        };
+
+        // A piece of a streamed body, made on the handler pool.
+        struct StreamPiece {
+            std::string data;
+            bool more = false;
+            bool failed = false;
+        };
+
+        // co_await offload(fn): runs fn on the handler pool and resumes on the worker's
+        // loop with its result, or with nothing if the pool refused the work. If the
+        // connection closes meanwhile the result is dropped and the frame never resumes.
+        template <typename Fn>
+        struct OffloadAwaiter {
+            using Result = std::invoke_result_t<Fn&>;
+
+            Connection& connection;
+            Fn fn;
+            std::optional<Result> result;
+
+            bool await_ready() const { return false; }
+
+            bool await_suspend(std::coroutine_handle<> handle) {
+                connection.waiting = handle;
+                connection.state = State::Handling;
+
+                Worker* owner = &connection.worker;
+                int fd = connection.socket_fd;
+                uint64_t id = connection.connection_id;
+                bool queued = connection.server.handler_pool.trySubmit([owner, fd, id, self = this, fn = std::move(fn)]() mutable {
+                    // The work runs from a temporary so whatever it holds (the batch, for
+                    // one) is released before the connection resumes and looks to reuse it
+                    Result value = [work = std::move(fn)]() mutable { return work(); }();
+                    owner->backend->post([owner, fd, id, self, value = std::move(value)]() mutable {
+                        if (Connection* alive = owner->findConnection(fd, id)) {
+                            self->result.emplace(std::move(value));
+                            alive->resume();
+                        }
+                    });
+                });
+                if (!queued) {
+                    connection.waiting = {};
+                }
+                return queued;
+            }
+
+            std::optional<Result> await_resume() { return std::move(result); }
+        };
+
+    public:
+        Connection(Worker& owner, int fd, uint64_t id, std::string ip)
+            : worker(owner), server(owner.server), socket_fd(fd), connection_id(id), client_ip(std::move(ip)),
+            request_started(owner.timers.now()), last_activity(owner.timers.now()),
+            timeout_timer([this] { onTimeout(); }), parser(owner.server.config.max_request_size) {}
+
+        int fd() const { return socket_fd; }
+        uint64_t id() const { return connection_id; }
+
+        void start() {
+            session = serve();
+            session.start();
+        }
+
+        // Between requests with nothing half-received: safe to close when draining.
+        void cancelTimeout() {
+            worker.timers.cancel(timeout_timer);
+        }
+
+        bool isIdle() const {
+            return state == State::Reading && in_buffer.empty();
+        }
+
+        void onReceive(const char* data, size_t length) override {
+            // Deadlines are checked when the timer fires, so activity costs no timer work
+            last_activity = worker.timers.now();
+            if (in_buffer.empty()) {
+                request_started = last_activity;
+            }
+            in_buffer.insert(in_buffer.end(), data, data + length);
+            if (state == State::Reading) {
+                if (waiting && frameBatch()) {
+                    resume();
+                }
+            }
+            else if (in_buffer.size() > server.config.max_request_size) {
+                // Pipelining far ahead of the responses; no legal request needs this much
+                worker.closeConnection(socket_fd);
+            }
+        }
+
+        void onEndOfStream() override {
+            // A client may half-close after sending its request; still answer it
+            peer_closed = true;
+            if (state == State::Reading) {
+                worker.closeConnection(socket_fd);
+            }
+        }
+
+        void onError(int) override {
+            worker.closeConnection(socket_fd);
+        }
+
+        void onSendProgress() override {
+            last_activity = worker.timers.now();
+        }
+
+        void onSendComplete() override {
+            if (state == State::Writing && waiting) {
+                resume();
+            }
+        }
+
+        void resume() {
+            std::exchange(waiting, {}).resume();
+        }
+
+    private:
+        // The whole life of the connection, in order. Returning closes it.
+        Task<> serve() {
+            try {
+                while (true) {
+                    prepareBatch();
+                    std::shared_ptr<Batch> current = co_await read();
+                    if (current->requests.empty()) {
+                        keep_alive = false;
+                        HttpResponse response;
+                        response.setError(rejected_status, rejected_status == 413 ? "Request too large" : "Malformed request");
+                        current->responses.push_back(std::move(response));
+                        co_await write();
+                        break;
+                    }
+
+                    // Handlers may block on disk, so they run on the handler pool
+                    // Named rather than built inside the co_await: GCC 12 destroys captures
+                    // of a lambda temporary in an await expression twice
+                    auto enqueued = std::chrono::steady_clock::now();
+                    auto run_batch = [&srv = server, current, enqueued] {
+                        srv.runBatch(*current, enqueued);
+                        return true;
+                    };
+                    if (!co_await offload(std::move(run_batch))) {
+                        server.metrics.requests_rejected.fetch_add(1, std::memory_order_relaxed);
+                        current->responses.push_back(server.serviceUnavailable());
+                    }
+
+                    co_await write();
+                    while (HttpResponse* streamed = current->streaming()) {
+                        if (!co_await streamBody(streamed->stream)) {
+                            keep_alive = false;     // Cut short; the client sees no last-chunk
+                            break;
+                        }
+                        streamed->stream.reset();
+                        if (current->written < current->responses.size()) {
+                            co_await write();
+                        }
+                    }
+                    if (!keep_alive) {
+                        break;
+                    }
+                }
+            }
+            catch (const std::exception& e) {
+                server.logger.error("Connection " + client_ip + " failed: " + e.what());
+            }
+            worker.closeConnection(socket_fd);
+        }
+
+        // Sends a streamed body one chunk at a time, making each on the handler pool once
+        // the one before it has gone out, so a slow client holds back the producer.
+        // False if the body had to be cut short.
+        Task<bool> streamBody(std::shared_ptr<BodyStream> stream) {
+            while (true) {
+                // Named rather than built inside the co_await (see serve())
+                auto next_piece = [stream, &log = server.logger] {
+                    StreamPiece piece;
+                    try {
+                        piece.more = stream->next(piece.data);
+                    }
+                    catch (const std::exception& e) {
+                        log.error(std::string("Streamed response failed: ") + e.what());
+                        piece.failed = true;
+                    }
+                    return piece;
+                };
+                std::optional<StreamPiece> piece = co_await offload(std::move(next_piece));
+                if (!piece || piece->failed) {
+                    co_return false;
+                }
+
+                chunk_data = std::move(piece->data);
+                if (!chunk_data.empty() || !piece->more) {
+                    co_await writeChunk(!piece->more);
+                }
+                if (!piece->more) {
+                    co_return true;
+                }
+            }
+        }
+
+        // Reuses the last batch unless the handler pool still holds a reference to it.
+        void prepareBatch() {
+            if (batch && batch.use_count() == 1) {
+                batch->clear();
+            }
+            else {
+                batch = std::make_shared<Batch>();
+            }
+        }
+
+        // Which deadline applies in the current phase, and when it falls. Waiting on the
+        // pool has none: the handler queue has its own deadline.
+        Timeout currentTimeout(uint64_t& deadline) const {
+            const Config& config = server.config;
+            int seconds = 0;
+            Timeout kind = Timeout::None;
+
+            if (state == State::Writing) {
+                kind = Timeout::Write;
+                seconds = config.write_timeout_secs;
+                deadline = last_activity;
+            }
+            else if (state == State::Reading && in_buffer.empty() && requests_served > 0) {
+                kind = Timeout::Idle;
+                seconds = config.keep_alive_timeout_secs;
+                deadline = last_activity;
+            }
+            else if (state == State::Reading && !headers_received) {
+                // From the first byte, not the last: trickling headers doesn't extend it
+                kind = Timeout::Header;
+                seconds = config.header_timeout_secs;
+                deadline = request_started;
+            }
+            else if (state == State::Reading) {
+                kind = Timeout::Body;
+                seconds = config.body_timeout_secs;
+                deadline = last_activity;
+            }
+
+            if (seconds <= 0) {
+                return Timeout::None;
+            }
+            deadline += worker.ticksFor(seconds);
+            return kind;
+        }
+
+        // Called on each change of phase; activity within a phase is picked up lazily.
+        void armTimeout() {
+            uint64_t deadline = 0;
+            if (currentTimeout(deadline) == Timeout::None) {
+                worker.timers.cancel(timeout_timer);
+                return;
+            }
+            uint64_t now = worker.timers.now();
+            worker.timers.schedule(timeout_timer, deadline > now ? deadline - now : 1);
+        }
+
+        void onTimeout() {
+            uint64_t deadline = 0;
+            Timeout kind = currentTimeout(deadline);
+            if (kind == Timeout::None) {
+                return;
+            }
+
+            uint64_t now = worker.timers.now();
+            if (deadline > now) {
+                worker.timers.schedule(timeout_timer, deadline - now);
+                return;
+            }
+
+            Metrics& metrics = server.metrics;
+            switch (kind) {
+            case Timeout::Header: metrics.header_timeouts.fetch_add(1, std::memory_order_relaxed); break;
+            case Timeout::Body: metrics.body_timeouts.fetch_add(1, std::memory_order_relaxed); break;
+            case Timeout::Idle: metrics.idle_timeouts.fetch_add(1, std::memory_order_relaxed); break;
+            case Timeout::Write: metrics.write_timeouts.fetch_add(1, std::memory_order_relaxed); break;
+            case Timeout::None: break;
+            }
+            worker.closeConnection(socket_fd);
+        }
+
+        ReadAwaiter read() {
+            return ReadAwaiter{ *this };
+        }
+
+        WriteAwaiter write() {
+            return WriteAwaiter{ *this };
+        }
+
+        ChunkAwaiter writeChunk(bool last) {
+            return ChunkAwaiter{ *this, last };
+        }
+
+        template <typename Fn>
+        OffloadAwaiter<Fn> offload(Fn fn) {
+            return OffloadAwaiter<Fn>{ *this, std::move(fn), std::nullopt };
+        }
+
+        // The batch's responses, in request order, up to the first whose body is streamed.
+        // The backend writes the lot together once the current callback returns.
+        void queueResponses() {
+            auto& responses = batch->responses;
+            if (batch->wire.empty()) {
+                prepareResponses();
+            }
+
+            state = State::Writing;
+            last_activity = worker.timers.now();
+            armTimeout();
+
+            // Heads and bodies are queued as separate segments, so no body is copied;
+            // the batch stays put until the next one is prepared, after the sends complete
+            while (batch->written < responses.size()) {
+                const HttpResponse& response = responses[batch->written];
+                const auto& head = batch->wire[batch->written];
+                ++batch->written;
+
+                worker.backend->send(socket_fd, head.data(), head.size());
+                if (response.head_only) {
+                    continue;
+                }
+                if (response.stream) {
+                    break;      // Its body follows as it is generated
+                }
+                if (!response.body.empty()) {
+                    worker.backend->send(socket_fd, reinterpret_cast<const char*>(response.body.data()), response.body.size());
+                }
+                if (const auto& shared = response.shared_body; shared && !shared->empty()) {
+                    const char* data = reinterpret_cast<const char*>(shared->data());
+                    size_t min_bytes = server.config.zerocopy_min_bytes;
+                    if (min_bytes > 0 && shared->size() >= min_bytes) {
+                        worker.backend->sendZeroCopy(socket_fd, data, shared->size(), shared);
+                    }
+                    else {
+                        worker.backend->send(socket_fd, data, shared->size());
+                    }
+                }
+                if (const auto& file = response.file_body; file && response.file_parts.empty() && file->length > 0) {
+                    worker.backend->sendFile(socket_fd, file->fd, file->offset, file->length);
+                }
+                for (const FilePart& part : response.file_parts) {
+                    worker.backend->send(socket_fd, part.head.data(), part.head.size());
+                    if (part.length > 0) {
+                        worker.backend->sendFile(socket_fd, response.file_body->fd, part.offset, part.length);
+                    }
+                }
+            }
+        }
+
+        // chunk_data in chunked framing; the buffers stay put until the send completes.
+        void queueChunk(bool last) {
+            state = State::Writing;
+            last_activity = worker.timers.now();
+            armTimeout();
+
+            if (!chunk_data.empty()) {
+                char* end = std::to_chars(chunk_head, chunk_head + sizeof(chunk_head) - 2, chunk_data.size(), 16).ptr;
+                *end++ = '\r';
+                *end++ = '\n';
+                worker.backend->send(socket_fd, chunk_head, static_cast<size_t>(end - chunk_head));
+                worker.backend->send(socket_fd, chunk_data.data(), chunk_data.size());
+                worker.backend->send(socket_fd, "\r\n", 2);
+            }
+            if (last) {
+                worker.backend->send(socket_fd, "0\r\n\r\n", 5);
+            }
+        }
+
+        // Once per batch: the connection headers, and every response's head.
+        void prepareResponses() {
+            auto& responses = batch->responses;
+            // Shed connections when overloaded or shutting down; nothing after a 503 is sent
+            auto rejected = std::find_if(responses.begin(), responses.end(),
+                [](const HttpResponse& response) { return response.status_code == 503; });
+            if (rejected != responses.end()) {
+                responses.erase(rejected + 1, responses.end());
+                keep_alive = false;
+            }
+            if (!server.running) {
+                keep_alive = false;
+            }
+
+            batch->wire.reserve(responses.size());
+            for (size_t i = 0; i < responses.size(); ++i) {
+                HttpResponse& response = responses[i];
+                bool last = i + 1 == responses.size();
+                if (!last || keep_alive) {
+                    int served = requests_served - static_cast<int>(responses.size() - 1 - i);
+                    response.headers.set(HeaderId::Connection, "keep-alive");
+                    // Formatted into the arena, which outlives the response
+                    constexpr size_t capacity = 48;
+                    char* text = static_cast<char*>(batch->arena.get()->allocate(capacity, 1));
+                    int length = std::snprintf(text, capacity, "timeout=%d, max=%d", server.config.keep_alive_timeout_secs,
+                        server.config.max_keep_alive_requests - served);
+                    response.headers.set(HeaderId::KeepAlive, HeaderValue::borrowed(std::string_view(text, static_cast<size_t>(length))));
+                }
+                else {
+                    response.headers.set(HeaderId::Connection, "close");
+                }
+
+                batch->wire.push_back(response.serializeHead(batch->arena.get()));
+            }
+        }
+
+        // Frames every complete request in the buffer (up to max_pipeline_depth) into
+        // the batch. True when read() has something to return.
+        bool frameBatch() {
+            if (rejected_status != 0) {
+                return true;
+            }
+
+            size_t consumed = 0;
+            headers_received = false;
+
+            auto& requests = batch->requests;
+            while (requests.size() < server.config.max_pipeline_depth) {
+                std::string_view data = std::string_view(in_buffer.data(), in_buffer.size()).substr(consumed);
+                HttpRequestParser::Status status = parser.parse(data);
+                if (status == HttpRequestParser::Status::TooLarge || status == HttpRequestParser::Status::Invalid) {
+                    // Answered once the requests framed ahead of it have been
+                    rejected_status = status == HttpRequestParser::Status::TooLarge ? 413 : 400;
+                    break;
+                }
+                if (status != HttpRequestParser::Status::Complete) {
+                    headers_received = status == HttpRequestParser::Status::NeedBody;
+                    break;
+                }
+
+                HttpRequest& request = requests.emplace_back();
+                parser.build(request, data);
+                request.client_ip = client_ip;
+                consumed += parser.requestSize();
+                parser.reset();
+
+                if (++requests_served > 1) {
+                    server.metrics.keep_alive_requests.fetch_add(1, std::memory_order_relaxed);
+                    if (requests_served == 2) {
+                        server.metrics.connections_reused.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                keep_alive = server.config.keep_alive_timeout_secs > 0 && request.wantsKeepAlive() &&
+                    requests_served < server.config.max_keep_alive_requests;
+                if (!keep_alive) {
+                    break;      // Whatever follows a closing request is never answered
+                }
+            }
+
+            if (consumed > 0) {
+                // The requests keep the bytes they were framed from; the rest stays here
+                batch->input.swap(in_buffer);
+                in_buffer.assign(batch->input.begin() + consumed, batch->input.end());
+                request_started = worker.timers.now();    // Whatever is left began arriving by now
+            }
+            return !requests.empty() || rejected_status != 0;
+        }
+    };
+
+    // Shared-nothing unit of the server: one thread, one I/O backend, one listener
+    // (its own SO_REUSEPORT socket when enabled) and the connections it accepted.
+    // Nothing on the accept or request path is shared with other workers.
+    class Worker : public IoAcceptor {
+    private:
+        std::unique_ptr<ListenSocket> own_listener;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+        uint64_t next_connection_id = 1;
+        bool draining = false;
+        TimerWheel::Timer drain_timer{ [this] { cutOffDrain(); } };
+
+        static constexpr auto TimerTick = std::chrono::milliseconds(100);
+
+    public:
+        Server& server;
+        TimerWheel timers;      // Every connection deadline on this loop
+        std::unique_ptr<IoBackend> backend;
+        std::thread thread;
+
+        Worker(Server& srv, ListenSocket* shared_listener) : server(srv) {
+            std::string fallback_reason;
+            backend = createIoBackend(server.config.io_backend, fallback_reason);
+            if (!fallback_reason.empty()) {
+                server.logger.warning("io_uring unavailable, using epoll: " + fallback_reason);
+            }
+
+            ListenSocket* listener = shared_listener;
+            if (listener == nullptr) {
+                own_listener = std::make_unique<ListenSocket>(std::to_string(server.config.port), server.listenOptions());
+                listener = own_listener.get();
+            }
+            backend->listen(listener->GetSocket(), shared_listener != nullptr, this);
+
+            // Ticks the loop was too busy to take are caught up on, so deadlines don't drift
+            backend->setTick(TimerTick, [this](uint64_t ticks) {
+                for (uint64_t i = 0; i < ticks; ++i) {
+                    timers.advance();
+                }
+            });
+        }
+
+        uint64_t ticksFor(int seconds) const {
+            return static_cast<uint64_t>(std::chrono::seconds(seconds) / TimerTick);
+        }
+
+        IoChannel* onAccept(int client_socket, std::string client_ip) override {
+            if (!server.running) {
+                return nullptr;
+            }
+
+            int nodelay = 1;
+            setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+            server.metrics.connections_accepted.fetch_add(1, std::memory_order_relaxed);
+            auto connection = std::make_unique<Connection>(*this, client_socket, next_connection_id++, std::move(client_ip));
+            Connection* channel = connection.get();
+            connections.emplace(client_socket, std::move(connection));
+            channel->start();
+            return channel;
+        }
+
+        void closeConnection(int client_socket) {
+            auto it = connections.find(client_socket);
+            if (it == connections.end()) {
+                return;
+            }
+
+            it->second->cancelTimeout();
+            backend->close(client_socket);
+            backend->deleteLater(std::move(it->second));
+            connections.erase(it);
+
+            if (draining && connections.empty()) {
+                backend->stop();
+            }
+        }
+
+        // Runs on the worker's thread after stop(): no new connections, idle ones go
+        // now, and the rest get until the grace deadline to finish their responses
+        // (which all carry Connection: close from here on).
+        void beginDrain() {
+            draining = true;
+
+            backend->stopListening();
+            own_listener.reset();
+
+            std::vector<int> idle;
+            for (const auto& [fd, connection] : connections) {
+                if (connection->isIdle()) {
+                    idle.push_back(fd);
+                }
+            }
+            for (int fd : idle) {
+                closeConnection(fd);
+            }
+
+            if (connections.empty()) {
+                backend->stop();
+            }
+            else if (server.config.shutdown_grace_secs > 0) {
+                timers.schedule(drain_timer, ticksFor(server.config.shutdown_grace_secs));
+            }
+            else {
+                cutOffDrain();
+            }
+        }
+
+        Connection* findConnection(int fd, uint64_t id) {
+            auto it = connections.find(fd);
+            return it != connections.end() && it->second->id() == id ? it->second.get() : nullptr;
+        }
+
+    private:
+        void cutOffDrain() {
+            if (!connections.empty()) {
+                server.logger.warning("Shutdown grace period over, cutting off " +
+                    std::to_string(connections.size()) + " connections");
+                std::vector<int> remaining;
+                for (const auto& [fd, connection] : connections) {
+                    remaining.push_back(fd);
+                }
+                for (int fd : remaining) {
+                    closeConnection(fd);
+                }
+            }
+            backend->stop();
+        }
+    };
+
+    std::unique_ptr<ListenSocket> shared_listener;
+    std::vector<std::unique_ptr<Worker>> workers;
 
 public:
-    FileServer(const Config& cfg)
+    Server(const Config& cfg)
         : config(cfg),
+        logger(cfg.log_file, cfg.enable_logging),
         file_manager(cfg.root_directory, logger),
-        static_server(cfg.web_directory, logger),
-        logger(cfg.log_file, cfg.enable_logging) {}
+        static_server(cfg.web_directory, logger, cfg.enable_compression),
+        handler_pool(cfg.handler_threads > 0 ? cfg.handler_threads : 2 * std::max(1u, std::thread::hardware_concurrency()),
+            cfg.handler_queue_depth) {}
 
+    // Blocks until stop() has drained every worker.
     void start() {
-        Socket socket(config.port);
-        SocketStream sockstream(socket);
-
-        int opt = 1;
-        setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        std::unique_lock<std::mutex> lifecycle(lifecycle_mutex);
+        if (stop_requested) {
+            return;
+        }
 
-        sockaddr_in address{};
-        address.sin_family = AF_INET;
-        address.sin_addr.s_addr = INADDR_ANY;
-        address.sin_port = htons(config.port);
+        unsigned worker_count = config.worker_threads > 0
+            ? static_cast<unsigned>(config.worker_threads)
+            : std::max(1u, std::thread::hardware_concurrency());
 
-        if (bind(server_socket, (struct sockaddr*)&address, sizeof(address)) < 0) {
-            throw std::runtime_error("Failed to bind socket");
+        // Without SO_REUSEPORT every worker has to share a single accept queue
+        if (!config.reuse_port) {
+            shared_listener = std::make_unique<ListenSocket>(std::to_string(config.port), listenOptions());
         }
 
-        if (listen(server_socket, 10) < 0) {
-            throw std::runtime_error("Failed to listen on socket");
+        // Bind every listener before any thread starts, so a bad port fails start() cleanly
+        for (unsigned i = 0; i < worker_count; ++i) {
+            workers.push_back(std::make_unique<Worker>(*this, shared_listener.get()));
         }
 
         running = true;
-        logger.info("File server starting on port " + std::to_string(config.port));
+        logger.info("File server starting on port " + std::to_string(config.port) +
+            " with " + std::to_string(worker_count) + " workers");
         logger.info("Serving files from: " + config.root_directory);
         logger.info("Serving web interface from: " + config.web_directory);
 
-        while (running) {
-            sockaddr_in client_addr{};
-            socklen_t client_len = sizeof(client_addr);
-            int client_socket = accept(server_socket, (struct sockaddr*)&client_addr, &client_len);
+        logger.info("I/O backend: " + std::string(workers.front()->backend->name()));
+        logger.info("Header scanning: " + std::string(HttpScan::kernelName()));
 
-            if (client_socket >= 0) {
-                std::string client_ip = inet_ntoa(client_addr.sin_addr);
-                std::thread(&FileServer::handleClient, this, client_socket, client_ip).detach();
-            }
+        for (auto& worker : workers) {
+            worker->thread = std::thread([&backend = *worker->backend] { backend.run(); });
         }
+        lifecycle.unlock();
+
+        for (auto& worker : workers) {
+            worker->thread.join();
+        }
+
+        // Handler tasks post back into the workers' backends, so they go first
+        handler_pool.shutdown();
+        workers.clear();
+        shared_listener.reset();
+
+        logger.info("Server stopped");
+        logger.flush();
     }
 
+    // Graceful: stops accepting, closes idle connections and lets in-flight responses
+    // finish for up to shutdown_grace_secs; start() returns once every worker is done.
+    // Safe to call from any thread, more than once, and before start().
     void stop() {
-        running = false;
-        close(server_socket);
-        logger.info("Server stopped");
+        std::lock_guard<std::mutex> lifecycle(lifecycle_mutex);
+        stop_requested = true;
+        if (!running.exchange(false)) {
+            return;
+        }
+
+        logger.info("Draining connections (grace period " + std::to_string(config.shutdown_grace_secs) + "s)");
+        for (auto& worker : workers) {
+            worker->backend->post([&w = *worker] { w.beginDrain(); });
+        }
     }
 
 private:
-    void handleClient(int client_socket, const std::string& client_ip) {
-        char buffer[8192];
-        ssize_t bytes_read = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
+    ListenSocket::Options listenOptions() const {
+        ListenSocket::Options options;
+        options.backlog = config.listen_backlog;
+        options.reuse_port = config.reuse_port;
+        options.defer_accept_secs = config.defer_accept_secs;
+        return options;
+    }
+
+    // Runs on the handler pool. A batch that sat in the queue past the deadline is
+    // answered with a single 503 instead: the client has likely given up already.
+    // Response bodies come out of the batch's arena.
+    void runBatch(Batch& batch, std::chrono::steady_clock::time_point enqueued) {
+        auto waited = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - enqueued);
+        metrics.recordQueueWait(static_cast<uint64_t>(waited.count()));
+
+        Arena::Scope scope(batch.arena);
+        if (waited > std::chrono::milliseconds(config.handler_queue_timeout_ms)) {
+            metrics.requests_expired.fetch_add(batch.requests.size(), std::memory_order_relaxed);
+            batch.responses.push_back(serviceUnavailable());
+            return;
+        }
+
+        batch.responses.reserve(batch.requests.size());
+        for (const auto& request : batch.requests) {
+            batch.responses.push_back(processRequest(request));
+        }
+    }
 
-        if (bytes_read > 0) {
-            buffer[bytes_read] = '\0';
-            HttpRequest request = HttpRequest::parse(std::string(buffer), client_ip);
+    HttpResponse processRequest(const HttpRequest& request) {
+        if (logger.isEnabled()) {
+            logger.info(request.client_ip + " " + std::string(request.method) + " " + std::string(request.path));
+        }
+        metrics.requests_total.fetch_add(1, std::memory_order_relaxed);
+
+        HttpResponse response = handleRequest(request);
+        addCorsHeaders(response);
+        compressResponse(request, response);
+        if (response.stream && request.version == "HTTP/1.0") {
+            // No chunked coding before HTTP/1.1: build the whole body after all
+            std::string body;
+            while (response.stream->next(body)) {
+            }
+            response.body.assign(body.begin(), body.end());
+            response.stream.reset();
+        }
+        // Content-Length stays as GET would have it; the body is never sent
+        response.head_only = request.method == "HEAD";
+        return response;
+    }
 
-            logger.info(client_ip + " " + request.method + " " + request.path);
+    // Content-Encoding per the request's Accept-Encoding, for successful text-like
+    // responses: whole bodies past the size threshold, and streams as they go. A body
+    // that doesn't get smaller goes out as it was.
+    void compressResponse(const HttpRequest& request, HttpResponse& response) {
+        if (!config.enable_compression || response.status_code != 200 || response.file_body ||
+                response.headers.contains(HeaderId::ContentEncoding)) {
+            return;
+        }
+        const HeaderValue* type = response.headers.get(HeaderId::ContentType);
+        if (type == nullptr || !isCompressible(type->view())) {
+            return;
+        }
 
-            HttpResponse response = handleRequest(request);
+        // Caches must key this response on the header, whichever coding we pick
+        response.headers.set(HeaderId::Vary, "Accept-Encoding");
+        ContentCoding coding = negotiateCoding(request.header(HeaderId::AcceptEncoding));
+        if (coding == ContentCoding::Identity) {
+            return;
+        }
 
-            if (config.enable_cors) {
-                response.headers["Access-Control-Allow-Origin"] = "*";
-                response.headers["Access-Control-Allow-Methods"] = "GET, POST, PUT, DELETE, OPTIONS";
-                response.headers["Access-Control-Allow-Headers"] = "Content-Type, Authorization";
+        if (response.stream) {
+            response.stream = std::make_shared<CompressedStream>(
+                std::move(response.stream), coding, config.compression_level, metrics);
+        }
+        else {
+            const uint8_t* data = response.shared_body ? response.shared_body->data() : response.body.data();
+            size_t size = response.shared_body ? response.shared_body->size() : response.body.size();
+            if (size < config.compression_min_bytes) {
+                return;
             }
 
-            std::string response_str = response.serialize();
-            send(client_socket, response_str.c_str(), response_str.length(), 0);
+            auto started = std::chrono::steady_clock::now();
+            std::pmr::vector<uint8_t> compressed{ Arena::current() };
+            Deflater::acquire(coding, config.compression_level)->compress(data, size, true, compressed);
+            auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - started);
+            metrics.recordCompression(size, compressed.size(), static_cast<uint64_t>(elapsed.count()));
+            if (compressed.size() >= size) {
+                return;
+            }
+
+            response.body = std::move(compressed);
+            response.shared_body.reset();
         }
 
-        close(client_socket);
+        // Other bytes than the tag was issued for: a validator of their own, so the
+        // two are never taken for each other
+        if (const HeaderValue* etag = response.headers.get(HeaderId::ETag)) {
+            response.headers.set(HeaderId::ETag, etagVariant(etag->view(), codingName(coding)));
+        }
+        response.headers.set(HeaderId::ContentEncoding, std::string(codingName(coding)));
+        metrics.compressed_responses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The tag compressResponse() gives a successful response of this type if it
+    // compresses it for this request; empty if it won't.
+    std::string recodedETag(const HttpRequest& request, std::string_view etag, std::string_view content_type) const {
+        if (!config.enable_compression || !isCompressible(content_type)) {
+            return {};
+        }
+        ContentCoding coding = negotiateCoding(request.header(HeaderId::AcceptEncoding));
+        return coding != ContentCoding::Identity ? etagVariant(etag, codingName(coding)) : std::string();
+    }
+
+    HttpResponse serviceUnavailable() {
+        HttpResponse response;
+        response.setError(503, "Server busy, retry later");
+        response.headers.set(HeaderId::RetryAfter, std::to_string(config.handler_retry_after_secs));
+        addCorsHeaders(response);
+        return response;
+    }
+
+    void addCorsHeaders(HttpResponse& response) const {
+        if (config.enable_cors) {
+            response.headers.set(HeaderId::AccessControlAllowOrigin, "*");
+            response.headers.set(HeaderId::AccessControlAllowMethods, "GET, POST, PUT, DELETE, OPTIONS");
+            response.headers.set(HeaderId::AccessControlAllowHeaders, "Content-Type, Authorization");
+        }
     }
 
     HttpResponse handleRequest(const HttpRequest& request) {
@@ -584,77 +1833,214 @@ private:
         }
 
         // Serve static files (web interface)
-        return static_server.serveFile(request.path);
+        return static_server.serveFile(request);
     }
 
+    // Routes are laid out at compile time (see RouteTable): one hash and one compare
+    // per request, whatever the number of endpoints.
     HttpResponse handleApiRequest(const HttpRequest& request) {
+        using ApiHandler = HttpResponse (Server::*)(const HttpRequest&);
+        static constexpr Route<ApiHandler> api_routes[] = {
+            { HttpMethod::Get, "/api/files", &Server::handleListFiles },
+            { HttpMethod::Get, "/api/download", &Server::handleDownload },
+            { HttpMethod::Post, "/api/upload", &Server::handleUpload },
+            { HttpMethod::Delete, "/api/delete", &Server::handleDelete },
+            { HttpMethod::Get, "/api/stats", &Server::handleStats },
+            { HttpMethod::Get, "/api/metrics", &Server::handleMetrics },
+        };
+        static constexpr RouteTable api_table(api_routes);
+
+        // HEAD goes to the GET handler; processRequest drops the body
+        HttpMethod method = httpMethod(request.method);
+        if (method == HttpMethod::Head) {
+            method = HttpMethod::Get;
+        }
+        if (const ApiHandler* handler = api_table.find(method, request.path)) {
+            return (this->**handler)(request);
+        }
+
         HttpResponse response;
+        response.setError(404, "API endpoint not found");
+        return response;
+    }
 
-        if (request.path == "/api/files" && request.method == "GET") {
-            auto params = request.parseQuery();
-            std::string path = params.count("path") ? params.at("path") : "";
+    HttpResponse handleListFiles(const HttpRequest& request) {
+        HttpResponse response;
+        std::string path = request.query<std::string>("path").value_or("");
+        bool ndjson = request.query<std::string>("format").value_or("") == "ndjson";
 
-            auto files = file_manager.listDirectory(path);
-            Json::Value json_files(Json::arrayValue);
+        std::optional<FileManager::Directory> directory = file_manager.findDirectory(path);
+        if (!directory) {
+            response.setJson(Json::Value(Json::arrayValue));
+            return response;
+        }
 
-            for (const auto& file : files) {
-                json_files.append(file.toJson());
-            }
+        // An unchanged directory costs the one stat() findDirectory() took, not a walk
+        std::string version = file_manager.directoryVersion(*directory, ndjson ? "ndjson" : "json");
+        const char* content_type = ndjson ? "application/x-ndjson" : "application/json";
+        response.headers.set(HeaderId::ETag, version);
+        response.headers.set(HeaderId::CacheControl, "no-cache");
+        std::string recoded = recodedETag(request, version, content_type);
+        std::string_view current = revalidatedETag(request, version, recoded);
+        if (etagListMatches(request.header(HeaderId::IfNoneMatch), current)) {
+            response.headers.set(HeaderId::ETag, std::string(current));
+            response.status_code = 304;
+            return response;
+        }
 
-            response.setJson(json_files);
+        fs::directory_iterator entries;
+        if (!file_manager.openDirectory(*directory, entries)) {
+            response = HttpResponse();
+            response.setJson(Json::Value(Json::arrayValue));
+            return response;
+        }
 
+        response.stream = std::make_shared<DirectoryListing>(file_manager, std::move(path), std::move(entries), ndjson);
+        if (ndjson) {
+            response.headers.set(HeaderId::ContentType, "application/x-ndjson");
         }
-        else if (request.path == "/api/download" && request.method == "GET") {
-            auto params = request.parseQuery();
-            if (!params.count("file")) {
-                response.setError(400, "Missing file parameter");
-                return response;
-            }
+        else {
+            response.headers.set(HeaderId::ContentType, "application/json");
+        }
+        return response;
+    }
 
-            auto file_data = file_manager.readFile(params.at("file"));
-            if (file_data.empty()) {
-                response.setError(404, "File not found");
-                return response;
-            }
+    HttpResponse handleDownload(const HttpRequest& request) {
+        HttpResponse response;
+        auto name = request.query<std::string>("file");
+        if (!name) {
+            response.setError(400, "Missing file parameter");
+            return response;
+        }
 
-            response.body = file_data;
-            response.headers["Content-Type"] = "application/octet-stream";
-            response.headers["Content-Disposition"] = "attachment; filename=\"" +
-                fs::path(params.at("file")).filename().string() + "\"";
+        auto file = file_manager.openFile(*name);
+        if (!file) {
+            response.setError(404, "File not found");
+            return response;
+        }
 
+        response.headers.set(HeaderId::ETag, file->etag);
+        response.headers.set(HeaderId::LastModified, formatHttpDate(file->modified));
+        if (isNotModified(request, file->etag, file->modified)) {
+            response.status_code = 304;
+            return response;
         }
-        else if (request.path == "/api/upload" && request.method == "POST") {
-            // TODO: Implement multipart form parsing
-            response.setError(501, "Upload not yet implemented");
+        logger.info("File downloaded: " + *name);
+
+        response.file_body = file;
+        response.headers.set(HeaderId::ContentType, "application/octet-stream");
+        response.headers.set(HeaderId::ContentDisposition, "attachment; filename=\"" +
+            fs::path(*name).filename().string() + "\"");
+        response.headers.set(HeaderId::AcceptRanges, "bytes");
+        applyRange(request, response);
+        return response;
+    }
 
+    // Narrows a file response to the ranges the request asks for: 206 with that one
+    // range, or with a multipart/byteranges body for several; 416 if none exists.
+    void applyRange(const HttpRequest& request, HttpResponse& response) {
+        FileBody& file = *response.file_body;
+        std::string_view range_header = request.header(HeaderId::Range);
+        if (range_header.empty() || !ifRangeMatches(request, file)) {
+            return;
         }
-        else if (request.path == "/api/delete" && request.method == "DELETE") {
-            auto params = request.parseQuery();
-            if (!params.count("file")) {
-                response.setError(400, "Missing file parameter");
-                return response;
-            }
 
-            bool success = file_manager.deleteFile(params.at("file"));
-            if (success) {
-                Json::Value result;
-                result["success"] = true;
-                result["message"] = "File deleted successfully";
-                response.setJson(result);
-            }
-            else {
-                response.setError(404, "File not found or could not be deleted");
-            }
+        uint64_t size = file.length;
+        auto ranges = parseRange(range_header, size);
+        if (!ranges) {
+            return;
+        }
+        if (ranges->empty()) {
+            response = HttpResponse();
+            response.setError(416, "Range not satisfiable");
+            response.headers.set(HeaderId::ContentRange, "bytes */" + std::to_string(size));
+            return;
+        }
 
+        auto content_range = [size](const ByteRange& range) {
+            return "bytes " + std::to_string(range.first) + "-" + std::to_string(range.last()) + "/" + std::to_string(size);
+        };
+
+        response.status_code = 206;
+        if (ranges->size() == 1) {
+            file.offset = ranges->front().first;
+            file.length = ranges->front().length;
+            response.headers.set(HeaderId::ContentRange, content_range(ranges->front()));
+            return;
         }
-        else if (request.path == "/api/stats" && request.method == "GET") {
-            response.setJson(file_manager.getStats());
 
+        static const std::string boundary = [] {
+            std::random_device random;
+            char text[17];
+            std::snprintf(text, sizeof(text), "%08x%08x", random(), random());
+            return std::string(text);
+        }();
+        std::string part_type(response.headers.get(HeaderId::ContentType)->view());
+        response.headers.set(HeaderId::ContentType, "multipart/byteranges; boundary=" + boundary);
+
+        response.file_parts.reserve(ranges->size() + 1);
+        for (const ByteRange& range : *ranges) {
+            std::string head = "\r\n--" + boundary + "\r\nContent-Type: " + part_type +
+                "\r\nContent-Range: " + content_range(range) + "\r\n\r\n";
+            response.file_parts.push_back({ std::move(head), range.first, range.length });
+        }
+        response.file_parts.push_back({ "\r\n--" + boundary + "--\r\n", 0, 0 });
+    }
+
+    // If-Range: the range is only wanted if the file hasn't changed since the client
+    // got the rest of it, judged by the download's ETag or Last-Modified date.
+    bool ifRangeMatches(const HttpRequest& request, const FileBody& file) {
+        std::string_view validator = request.header(HeaderId::IfRange);
+        if (validator.empty()) {
+            return true;
+        }
+        if (validator.starts_with('"') || validator.starts_with("W/")) {
+            // Strong comparison: a weak tag never matches
+            return validator == file.etag;
+        }
+        auto date = parseHttpDate(validator);
+        return date && *date == file.modified;
+    }
+
+    HttpResponse handleUpload(const HttpRequest&) {
+        HttpResponse response;
+        // TODO: Implement multipart form parsing
+        response.setError(501, "Upload not yet implemented");
+        return response;
+    }
+
+    HttpResponse handleDelete(const HttpRequest& request) {
+        HttpResponse response;
+        auto name = request.query<std::string>("file");
+        if (!name) {
+            response.setError(400, "Missing file parameter");
+            return response;
+        }
+
+        bool success = file_manager.deleteFile(*name);
+        if (success) {
+            Json::Value result;
+            result["success"] = true;
+            result["message"] = "File deleted successfully";
+            response.setJson(result);
         }
         else {
-            response.setError(404, "API endpoint not found");
+            response.setError(404, "File not found or could not be deleted");
         }
+        return response;
+    }
 
+    HttpResponse handleStats(const HttpRequest&) {
+        HttpResponse response;
+        response.setJson(file_manager.getStats(handler_pool));
+        return response;
+    }
+
+    HttpResponse handleMetrics(const HttpRequest&) {
+        HttpResponse response;
+        Json::Value json = metrics.toJson();
+        json["handler_queue_depth"] = static_cast<Json::UInt64>(handler_pool.queueDepth());
+        response.setJson(json);
         return response;
     }
 };
\ No newline at end of file
@@ -3,19 +3,40 @@
 class Server 
 {
 public:
-    FileServer(const Config& cfg);
+    Server(const Config& cfg);
     void start();
     void stop();
 
 private:
+    class Connection;
+    class Worker;
+    struct Batch;
+
     Config config;
-    int server_socket;
+    Logger logger;
     FileManager file_manager;
     StaticFileServer static_server;
-    Logger logger;
-    bool running = false;
+    Metrics metrics;
+    ThreadPool handler_pool;
+    std::atomic<bool> running{ false };
+    std::mutex lifecycle_mutex;
+    bool stop_requested = false;
+    std::unique_ptr<ListenSocket> shared_listener;
+    std::vector<std::unique_ptr<Worker>> workers;
 
-    void handleClient(int client_socket, const std::string& client_ip);
+    ListenSocket::Options listenOptions() const;
+    void runBatch(Batch& batch, std::chrono::steady_clock::time_point enqueued);
+    HttpResponse processRequest(const HttpRequest& request);
+    HttpResponse serviceUnavailable();
+    void addCorsHeaders(HttpResponse& response) const;
     HttpResponse handleRequest(const HttpRequest& request);
     HttpResponse handleApiRequest(const HttpRequest& request);
-};
\ No newline at end of file
+    HttpResponse handleListFiles(const HttpRequest& request);
+    HttpResponse handleDownload(const HttpRequest& request);
+    void applyRange(const HttpRequest& request, HttpResponse& response);
+    bool ifRangeMatches(const HttpRequest& request, const FileBody& file);
+    HttpResponse handleUpload(const HttpRequest& request);
+    HttpResponse handleDelete(const HttpRequest& request);
+    HttpResponse handleStats(const HttpRequest& request);
+    HttpResponse handleMetrics(const HttpRequest& request);
+};
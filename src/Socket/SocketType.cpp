@@ -77,3 +77,102 @@ Socket::~Socket()
 #endif
     }
 }
+
+ListenSocket::ListenSocket(const std::string& port, const Options& options) : m_socket(INVALID_SOCKET)
+{
+    struct addrinfo hints{};
+    struct addrinfo* res = nullptr;
+
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = AI_PASSIVE;      // Wildcard address
+
+    int err = getaddrinfo(nullptr, port.c_str(), &hints, &res);
+    if (err != 0 || res == nullptr)
+    {
+        throw std::runtime_error("getaddrinfo failed");
+    }
+
+#ifdef _WIN32
+    m_socket = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+#else
+    m_socket = socket(res->ai_family, res->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, res->ai_protocol);
+#endif
+    if (m_socket == INVALID_SOCKET)
+    {
+        freeaddrinfo(res);
+        throw std::runtime_error("socket creation failed");
+    }
+
+    int opt = 1;
+    setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&opt), sizeof(opt));
+
+#ifdef SO_REUSEPORT
+    if (options.reuse_port &&
+        setsockopt(m_socket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+    {
+        freeaddrinfo(res);
+        closeSocket(m_socket);
+        throw std::runtime_error("SO_REUSEPORT failed");
+    }
+#endif
+
+#ifdef TCP_DEFER_ACCEPT
+    if (options.defer_accept_secs > 0)
+    {
+        int secs = options.defer_accept_secs;
+        setsockopt(m_socket, IPPROTO_TCP, TCP_DEFER_ACCEPT, &secs, sizeof(secs));
+    }
+#endif
+
+    if (bind(m_socket, res->ai_addr, static_cast<int>(res->ai_addrlen)) != 0)
+    {
+        freeaddrinfo(res);
+        closeSocket(m_socket);
+        throw std::runtime_error("bind failed");
+    }
+    freeaddrinfo(res);
+
+    if (listen(m_socket, options.backlog) != 0)
+    {
+        closeSocket(m_socket);
+        throw std::runtime_error("listen failed");
+    }
+
+#ifdef _WIN32
+    u_long non_blocking = 1;
+    ioctlsocket(m_socket, FIONBIO, &non_blocking);
+#endif
+}
+
+ListenSocket::~ListenSocket()
+{
+    if (m_socket != INVALID_SOCKET)
+    {
+        closeSocket(m_socket);
+    }
+}
+
+socket_t ListenSocket::Accept(std::string& client_ip) const
+{
+    sockaddr_in client_addr{};
+    socklen_t client_len = sizeof(client_addr);
+
+#ifdef _WIN32
+    socket_t client = accept(m_socket, reinterpret_cast<sockaddr*>(&client_addr), &client_len);
+#else
+    socket_t client = accept4(m_socket, reinterpret_cast<sockaddr*>(&client_addr), &client_len,
+                              SOCK_NONBLOCK | SOCK_CLOEXEC);
+#endif
+    if (client == INVALID_SOCKET)
+    {
+        return INVALID_SOCKET;
+    }
+
+    char ip[INET_ADDRSTRLEN] = {};
+    inet_ntop(AF_INET, &client_addr.sin_addr, ip, sizeof(ip));
+    client_ip = ip;
+
+    return client;
+}
@@ -16,6 +16,9 @@ inline int closeSocket(socket_t socket) { return closesocket(socket); }
 #include <netdb.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
 #define INVALID_SOCKET (-1)
 using socket_t = int;
 inline int closeSocket(socket_t socket) { return close(socket); }
@@ -32,4 +35,31 @@ public:
 
 private:
     socket_t m_socket;
-};
\ No newline at end of file
+};
+
+// Server-side counterpart of Socket: bound, listening and non-blocking.
+class ListenSocket
+{
+public:
+    struct Options
+    {
+        int backlog = SOMAXCONN;
+        bool reuse_port = false;     // Lets several sockets bind the same port (Linux/BSD)
+        int defer_accept_secs = 0;   // TCP_DEFER_ACCEPT, Linux only; 0 disables
+    };
+
+    ListenSocket(const std::string& port, const Options& options);
+    ~ListenSocket();
+
+    ListenSocket(const ListenSocket&) = delete;
+    ListenSocket& operator=(const ListenSocket&) = delete;
+
+    // Returns INVALID_SOCKET once the accept queue is empty or on error; check errno.
+    // Accepted sockets are non-blocking and close-on-exec.
+    socket_t Accept(std::string& client_ip) const;
+
+    socket_t GetSocket() const { return m_socket; }
+
+private:
+    socket_t m_socket;
+};
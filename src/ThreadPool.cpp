@@ -0,0 +1,192 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+namespace {
+    // Which pool (and which of its deques) the current thread works for.
+    thread_local const ThreadPool* current_pool = nullptr;
+    thread_local size_t current_index = 0;
+}
+
+ThreadPool::ThreadPool(size_t thread_count, size_t queue_limit) : max_queue(queue_limit) {
+    thread_count = std::max<size_t>(1, thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        local_queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+bool ThreadPool::trySubmit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        if (stopping || inject_queue.size() >= max_queue) {
+            return false;
+        }
+        pending.fetch_add(1, std::memory_order_release);
+        inject_queue.push_back(std::move(task));
+    }
+    notifyOne();
+    return true;
+}
+
+void ThreadPool::spawn(std::function<void()> task) {
+    // Count first so a thief never sees a task that pending doesn't cover
+    pending.fetch_add(1, std::memory_order_release);
+    if (current_pool == this) {
+        WorkerQueue& queue = *local_queues[current_index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    else {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        inject_queue.push_back(std::move(task));
+    }
+    notifyOne();
+}
+
+bool ThreadPool::runPending() {
+    size_t index = current_pool == this ? current_index : 0;
+    std::function<void()> task;
+    // Helping a fork/join wait: don't pick up unrelated requests from the inject queue
+    if (!takeTask(index, task, false)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+size_t ThreadPool::queueDepth() const {
+    std::lock_guard<std::mutex> lock(inject_mutex);
+    return inject_queue.size();
+}
+
+void ThreadPool::shutdown() {
+    if (stopping.exchange(true)) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_cv.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    current_pool = this;
+    current_index = index;
+
+    while (true) {
+        std::function<void()> task;
+        if (takeTask(index, task, true)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        sleep_cv.wait(lock, [this] {
+            return stopping.load(std::memory_order_acquire) || pending.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping && pending == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, std::function<void()>& task, bool include_injected) {
+    if (pending.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+
+    // 1. Newest subtask on our own deque: its data is most likely still in cache
+    {
+        WorkerQueue& own = *local_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // 2. Oldest request from outside the pool
+    if (include_injected) {
+        std::lock_guard<std::mutex> lock(inject_mutex);
+        if (!inject_queue.empty()) {
+            task = std::move(inject_queue.front());
+            inject_queue.pop_front();
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    // 3. Oldest subtask of a busy sibling, which is usually the biggest chunk left
+    for (size_t offset = 1; offset < local_queues.size(); ++offset) {
+        WorkerQueue& victim = *local_queues[(index + offset) % local_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ThreadPool::notifyOne() {
+    // Taking the lock orders this with a worker that is between its check and its wait
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+    }
+    sleep_cv.notify_one();
+}
+
+void TaskGroup::spawn(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++outstanding;
+    }
+    pool.spawn([this, task = std::move(task)] {
+        task();
+        // Notified under the lock: once it is released, wait() may return and the
+        // group may be gone
+        std::lock_guard<std::mutex> lock(mutex);
+        --outstanding;
+        ++changes;
+        changed_cv.notify_all();
+    });
+
+    // Queued now: a waiter that found nothing to run may help with this one
+    std::lock_guard<std::mutex> lock(mutex);
+    ++changes;
+    changed_cv.notify_all();
+}
+
+void TaskGroup::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (outstanding > 0) {
+        size_t seen = changes;
+        lock.unlock();
+        // Help out first: the subtasks may be sitting on this thread's deque
+        bool helped = pool.runPending();
+        lock.lock();
+        if (!helped) {
+            // What is left runs on other threads; sleep until one finishes or queues more
+            changed_cv.wait(lock, [this, seen] { return changes != seen; });
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Requests submitted from outside enter a bounded FIFO inject
+// queue; tasks spawned by a running task go on that thread's own deque. Threads run
+// their own newest work first, then the oldest injected request, then steal the
+// oldest work from a sibling - so a request that splits itself up is finished by
+// whoever is idle instead of holding up the requests queued behind it.
+class ThreadPool 
+{
+public:
+    ThreadPool(size_t thread_count, size_t queue_limit);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Admission-controlled entry point: refuses the task when the inject queue is full.
+    bool trySubmit(std::function<void()> task);
+
+    // Subtask of work already admitted; never refused.
+    void spawn(std::function<void()> task);
+
+    // Runs one queued subtask on the calling thread, if any can be found.
+    bool runPending();
+
+    size_t queueDepth() const;
+
+    // Runs whatever is still queued, then joins the threads.
+    void shutdown();
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    size_t max_queue;
+    std::vector<std::unique_ptr<WorkerQueue>> local_queues;
+
+    mutable std::mutex inject_mutex;
+    std::deque<std::function<void()>> inject_queue;
+
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+    std::atomic<size_t> pending{ 0 };
+    std::atomic<bool> stopping{ false };
+
+    std::vector<std::thread> threads;
+
+    void workerLoop(size_t index);
+    bool takeTask(size_t index, std::function<void()>& task, bool include_injected);
+    void notifyOne();
+};
+
+// Fork/join helper: spawn subtasks, then wait() runs queued work until they finish,
+// sleeping while the last of them run on other threads.
+class TaskGroup 
+{
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool) {}
+    ~TaskGroup() { wait(); }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    void spawn(std::function<void()> task);
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::mutex mutex;
+    std::condition_variable changed_cv;
+    size_t outstanding = 0;
+    size_t changes = 0;     // Bumped whenever a subtask is queued or finishes
+};
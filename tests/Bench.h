@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Timing for the benchmark executables. They build with the tests, but CTest doesn't
+// run them: there is nothing to pass or fail, and the numbers only mean something in
+// a Release build on an otherwise quiet machine.
+
+// Keeps the compiler from dropping a computation whose result is otherwise unused.
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Nanoseconds one call of body() takes: calls are timed in rounds, doubled in size
+// until a round lasts a few milliseconds, and the fastest of several rounds counts.
+template <typename Body>
+double nsPerCall(Body&& body) {
+    using Clock = std::chrono::steady_clock;
+    auto time = [&](long calls) {
+        auto start = Clock::now();
+        for (long i = 0; i < calls; ++i) {
+            body();
+        }
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    long calls = 1;
+    while (time(calls) < 5e6) {
+        calls *= 2;
+    }
+    double best = time(calls);
+    for (int round = 0; round < 6; ++round) {
+        best = std::min(best, time(calls));
+    }
+    return best / static_cast<double>(calls);
+}
+
+// One result line; against a baseline, how many times faster the result is.
+inline void report(const char* label, double ns, double baseline_ns = 0) {
+    if (baseline_ns > 0) {
+        std::printf("  %-44s %10.1f ns  %5.2fx\n", label, ns, baseline_ns / ns);
+    }
+    else {
+        std::printf("  %-44s %10.1f ns\n", label, ns);
+    }
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstdio>
+
+// Bare-bones assertions for the test executables. A failed CHECK reports where it
+// failed and the test carries on; main() returns checkFailures() for CTest.
+inline int& checkFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition)                                                            \
+    do {                                                                            \
+        if (!(condition)) {                                                         \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++checkFailures();                                                      \
+        }                                                                           \
+    } while (false)
@@ -0,0 +1,161 @@
+#include "Check.h"
+#include "Compression.h"
+
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+namespace {
+    // Inflates a whole gzip or zlib stream; empty on any error.
+    std::string inflateAll(const std::string& data, ContentCoding coding, bool require_end = true) {
+        z_stream stream{};
+        if (inflateInit2(&stream, coding == ContentCoding::Gzip ? 15 + 16 : 15) != Z_OK) {
+            return {};
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+
+        std::string out;
+        int result = Z_OK;
+        while (result == Z_OK) {
+            char buffer[4096];
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            result = inflate(&stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+            if (result == Z_BUF_ERROR && stream.avail_in == 0 && !require_end) {
+                result = Z_STREAM_END;
+            }
+        }
+        inflateEnd(&stream);
+        return result == Z_STREAM_END ? out : std::string();
+    }
+
+    void testAcceptsCoding() {
+        CHECK(acceptsCoding("gzip", ContentCoding::Gzip));
+        CHECK(acceptsCoding("deflate, gzip;q=1.0", ContentCoding::Gzip));
+        CHECK(acceptsCoding("GZIP", ContentCoding::Gzip));
+        CHECK(acceptsCoding("x-gzip", ContentCoding::Gzip));
+        CHECK(acceptsCoding(" br , gzip ; q=0.5 ", ContentCoding::Gzip));
+        CHECK(acceptsCoding("gzip;q=0.001", ContentCoding::Gzip));
+        CHECK(!acceptsCoding("", ContentCoding::Gzip));
+        CHECK(!acceptsCoding("deflate", ContentCoding::Gzip));
+        CHECK(!acceptsCoding("gzipped", ContentCoding::Gzip));
+
+        // q=0 rules a coding out, however it's written
+        CHECK(!acceptsCoding("gzip;q=0", ContentCoding::Gzip));
+        CHECK(!acceptsCoding("gzip; Q=0.000", ContentCoding::Gzip));
+        CHECK(!acceptsCoding("gzip;q=0.", ContentCoding::Gzip));
+
+        // "*" covers the codings the header doesn't name
+        CHECK(acceptsCoding("*", ContentCoding::Gzip));
+        CHECK(acceptsCoding("br, *;q=0.1", ContentCoding::Zstd));
+        CHECK(!acceptsCoding("*;q=0", ContentCoding::Deflate));
+        CHECK(!acceptsCoding("*, gzip;q=0", ContentCoding::Gzip));
+        CHECK(acceptsCoding("*;q=0, gzip", ContentCoding::Gzip));
+
+        CHECK(acceptsCoding("zstd, gzip", ContentCoding::Zstd));
+    }
+
+    void testNegotiate() {
+        CHECK(negotiateCoding("gzip, deflate, br") == ContentCoding::Gzip);
+        CHECK(negotiateCoding("deflate") == ContentCoding::Deflate);
+        CHECK(negotiateCoding("gzip;q=0, deflate") == ContentCoding::Deflate);
+        CHECK(negotiateCoding("br") == ContentCoding::Identity);
+        CHECK(negotiateCoding("") == ContentCoding::Identity);
+        CHECK(negotiateCoding("identity") == ContentCoding::Identity);
+        CHECK(negotiateCoding("*") == ContentCoding::Gzip);
+        CHECK(negotiateCoding("*;q=0") == ContentCoding::Identity);
+
+        CHECK(codingName(ContentCoding::Gzip) == "gzip");
+        CHECK(codingName(ContentCoding::Deflate) == "deflate");
+        CHECK(codingName(ContentCoding::Zstd) == "zstd");
+        CHECK(codingName(ContentCoding::Identity).empty());
+    }
+
+    void testCompressible() {
+        CHECK(isCompressible("text/html"));
+        CHECK(isCompressible("text/css; charset=utf-8"));
+        CHECK(isCompressible("application/json"));
+        CHECK(isCompressible("application/ld+json"));
+        CHECK(isCompressible("application/javascript"));
+        CHECK(isCompressible("image/svg+xml"));
+        CHECK(!isCompressible("image/png"));
+        CHECK(!isCompressible("video/mp4"));
+        CHECK(!isCompressible("application/zip"));
+        CHECK(!isCompressible("application/octet-stream"));
+        CHECK(!isCompressible(""));
+    }
+
+    std::string sampleText() {
+        std::string text;
+        for (int i = 0; i < 2000; ++i) {
+            text += "<li class=\"file\">file-" + std::to_string(i) + ".txt</li>\n";
+        }
+        return text;
+    }
+
+    void testRoundTrip(ContentCoding coding) {
+        std::string text = sampleText();
+        Deflater::Handle deflater = Deflater::acquire(coding, 6);
+        std::string compressed;
+        deflater->compress(text.data(), text.size(), true, compressed);
+        CHECK(compressed.size() < text.size() / 4);
+        CHECK(inflateAll(compressed, coding) == text);
+
+        // Empty body
+        deflater.reset();
+        deflater = Deflater::acquire(coding, 6);
+        std::string empty;
+        deflater->compress("", 0, true, empty);
+        CHECK(!empty.empty());
+        CHECK(inflateAll(empty, coding).empty());
+    }
+
+    // Chunk by chunk, as a chunked response compresses: each flush decodes on its own
+    // and the whole stream decodes to the concatenation.
+    void testStreaming() {
+        std::string text = sampleText();
+        Deflater::Handle deflater = Deflater::acquire(ContentCoding::Gzip, 1);
+        std::string compressed;
+        size_t chunk = 7000;
+        for (size_t at = 0; at < text.size(); at += chunk) {
+            deflater->compress(text.data() + at, std::min(chunk, text.size() - at), false, compressed);
+            std::string so_far = inflateAll(compressed, ContentCoding::Gzip, false);
+            CHECK(so_far == text.substr(0, std::min(at + chunk, text.size())));
+        }
+        deflater->compress(nullptr, 0, true, compressed);
+        CHECK(inflateAll(compressed, ContentCoding::Gzip) == text);
+    }
+
+    // A released deflater is reset and handed out again for the same coding and level.
+    void testReuse() {
+        Deflater::Handle first = Deflater::acquire(ContentCoding::Gzip, 6);
+        Deflater* raw = first.get();
+        std::string out;
+        first->compress("abandoned halfway", 17, false, out);
+        first.reset();
+
+        Deflater::Handle other_level = Deflater::acquire(ContentCoding::Gzip, 1);
+        CHECK(other_level.get() != raw);
+        Deflater::Handle again = Deflater::acquire(ContentCoding::Gzip, 6);
+        CHECK(again.get() == raw);
+
+        std::string text = "fresh message";
+        std::string compressed;
+        again->compress(text.data(), text.size(), true, compressed);
+        CHECK(inflateAll(compressed, ContentCoding::Gzip) == text);
+    }
+}
+
+int main() {
+    testAcceptsCoding();
+    testNegotiate();
+    testCompressible();
+    testRoundTrip(ContentCoding::Gzip);
+    testRoundTrip(ContentCoding::Deflate);
+    testStreaming();
+    testReuse();
+    return checkFailures();
+}
@@ -0,0 +1,97 @@
+#include "Bench.h"
+#include "HttpRequest.h"
+
+#include <map>
+#include <sstream>
+#include <string>
+
+// Query decoding on listing and download requests for long non-ASCII paths, which are
+// mostly %xx escapes: the old parseQuery() and urlDecode() against QueryView and
+// percentDecode().
+namespace {
+    namespace before {
+        std::string urlDecode(const std::string& str) {
+            std::string result;
+            for (size_t i = 0; i < str.length(); ++i) {
+                if (str[i] == '%' && i + 2 < str.length()) {
+                    int value = std::stoi(str.substr(i + 1, 2), nullptr, 16);
+                    result += static_cast<char>(value);
+                    i += 2;
+                }
+                else if (str[i] == '+') {
+                    result += ' ';
+                }
+                else {
+                    result += str[i];
+                }
+            }
+            return result;
+        }
+
+        std::map<std::string, std::string> parseQuery(const std::string& query_string) {
+            std::map<std::string, std::string> params;
+            std::istringstream stream(query_string);
+            std::string pair;
+
+            while (std::getline(stream, pair, '&')) {
+                size_t equals = pair.find('=');
+                if (equals != std::string::npos) {
+                    params[pair.substr(0, equals)] = urlDecode(pair.substr(equals + 1));
+                }
+            }
+            return params;
+        }
+    }
+
+    // Every byte escaped, as browsers send UTF-8.
+    std::string escape(const std::string& text) {
+        static const char hex[] = "0123456789ABCDEF";
+        std::string escaped;
+        for (unsigned char c : text) {
+            escaped += '%';
+            escaped += hex[c >> 4];
+            escaped += hex[c & 15];
+        }
+        return escaped;
+    }
+
+    struct Case {
+        const char* label;
+        std::string query;
+        const char* name;       // The parameter the handler asks for
+    };
+}
+
+int main() {
+    const std::string japanese = "写真/2024年/夏休み/北海道旅行/富良野のラベンダー畑.jpg";
+    const std::string russian = "Документы/Бухгалтерия/Отчёты за 2024 год/Квартальный отчёт №3.pdf";
+    const Case cases[] = {
+        { "listing, Japanese path", "path=" + escape(japanese.substr(0, japanese.rfind('/'))), "path" },
+        { "download, Japanese path", "file=" + escape(japanese), "file" },
+        { "download, Russian path, after format", "format=ndjson&file=" + escape(russian), "file" },
+        { "listing, ASCII path", "path=backups/2024/db", "path" },
+    };
+
+    for (const Case& c : cases) {
+        std::printf("%s (%zu bytes)\n", c.label, c.query.size());
+        const std::string name = c.name;
+        double old_ns = nsPerCall([&] {
+            auto params = before::parseQuery(c.query);
+            keep(params.count(name) ? params.at(name) : "");
+        });
+        double new_ns = nsPerCall([&] { keep(QueryView(c.query).get<std::string>(c.name)); });
+        double decode_ns = nsPerCall([&] {
+            std::string value = c.query.substr(c.query.find(c.name) + name.size() + 1);
+            value.resize(percentDecode(value.data(), value.size(), true));
+            keep(value);
+        });
+        double old_decode_ns = nsPerCall([&] {
+            keep(before::urlDecode(c.query.substr(c.query.find(c.name) + name.size() + 1)));
+        });
+        report("before: parseQuery, then the parameter", old_ns);
+        report("QueryView::get<std::string>", new_ns, old_ns);
+        report("before: urlDecode alone", old_decode_ns);
+        report("percentDecode alone", decode_ns, old_decode_ns);
+    }
+    return 0;
+}
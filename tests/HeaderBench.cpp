@@ -0,0 +1,138 @@
+#include "Bench.h"
+#include "HttpHeaders.h"
+#include "RequestCorpus.h"
+
+#include <charconv>
+#include <map>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Header storage, std::map<std::string, std::string> as requests and responses had it
+// against HeaderList: filling in and looking up a request's headers, and building and
+// serialising a typical response's.
+namespace {
+    struct Header {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // Each corpus request's headers, split as the parser splits them.
+    std::vector<std::vector<Header>> corpusHeaders() {
+        std::vector<std::vector<Header>> requests;
+        for (const std::string& text : requestCorpus()) {
+            std::vector<Header>& headers = requests.emplace_back();
+            std::string_view rest(text);
+            rest.remove_prefix(rest.find("\r\n") + 2);
+            for (size_t end; (end = rest.find("\r\n")) != 0 && end != std::string_view::npos;) {
+                std::string_view line = rest.substr(0, end);
+                size_t colon = line.find(':');
+                headers.push_back({ line.substr(0, colon), line.substr(colon + 2) });
+                rest.remove_prefix(end + 2);
+            }
+        }
+        return requests;
+    }
+
+    // What the server asks of every request.
+    constexpr HeaderId Lookups[] = { HeaderId::Host, HeaderId::ContentLength, HeaderId::Connection,
+        HeaderId::AcceptEncoding, HeaderId::IfNoneMatch, HeaderId::Range };
+
+    double requestMap(const std::vector<std::vector<Header>>& requests) {
+        return nsPerCall([&] {
+            for (const auto& headers : requests) {
+                std::map<std::string, std::string> map;
+                for (const Header& header : headers) {
+                    map[std::string(header.name)] = std::string(header.value);
+                }
+                for (HeaderId id : Lookups) {
+                    keep(map.find(std::string(headerName(id))));
+                }
+            }
+        });
+    }
+
+    double requestList(const std::vector<std::vector<Header>>& requests) {
+        return nsPerCall([&] {
+            for (const auto& headers : requests) {
+                HeaderList<std::string_view> list;
+                for (const Header& header : headers) {
+                    list.add(headerId(header.name), header.name, header.value);
+                }
+                for (HeaderId id : Lookups) {
+                    keep(list.get(id));
+                }
+            }
+        });
+    }
+
+    // A JSON answer with the CORS headers: the old HttpResponse constructor and
+    // serialize(), body aside.
+    double responseMap() {
+        return nsPerCall([] {
+            std::map<std::string, std::string> headers;
+            headers.insert_or_assign("X-Frame-Options", "DENY");
+            headers.insert_or_assign("X-Content-Type-Options", "nosniff");
+            headers.insert_or_assign("X-XSS-Protection", "1; mode=block");
+            headers.insert_or_assign("Content-Type", "application/json");
+            headers.insert_or_assign("Access-Control-Allow-Origin", "*");
+            headers.insert_or_assign("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
+            headers.insert_or_assign("Access-Control-Allow-Headers", "Content-Type, Authorization");
+
+            std::ostringstream response;
+            response << "HTTP/1.1 " << 200 << " " << "OK" << "\r\n";
+            auto headers_copy = headers;
+            headers_copy["Content-Length"] = std::to_string(1234);
+            headers_copy["Server"] = "RaspberryPi-FileServer/1.0";
+            for (const auto& [key, value] : headers_copy) {
+                response << key << ": " << value << "\r\n";
+            }
+            response << "\r\n";
+            keep(response.str());
+        });
+    }
+
+    // The same answer as HttpResponse and its serializeHead() build it now.
+    double responseList() {
+        return nsPerCall([] {
+            HeaderList<HeaderValue> headers;
+            headers.set(HeaderId::XFrameOptions, "DENY");
+            headers.set(HeaderId::XContentTypeOptions, "nosniff");
+            headers.set(HeaderId::XXssProtection, "1; mode=block");
+            headers.set(HeaderId::ContentType, "application/json");
+            headers.set(HeaderId::AccessControlAllowOrigin, "*");
+            headers.set(HeaderId::AccessControlAllowMethods, "GET, POST, PUT, DELETE, OPTIONS");
+            headers.set(HeaderId::AccessControlAllowHeaders, "Content-Type, Authorization");
+
+            std::string response;
+            response.reserve(512);
+            response += "HTTP/1.1 200 OK\r\n";
+            for (const auto& header : headers) {
+                response += header.name;
+                response += ": ";
+                response += header.value.view();
+                response += "\r\n";
+            }
+            char number[24];
+            response += "Content-Length: ";
+            response.append(number, std::to_chars(number, number + sizeof(number), 1234).ptr);
+            response += "\r\nServer: RaspberryPi-FileServer/1.0\r\n\r\n";
+            keep(response);
+        });
+    }
+}
+
+int main() {
+    std::vector<std::vector<Header>> requests = corpusHeaders();
+    std::printf("request headers, %zu requests: fill in, then %zu lookups each\n", requests.size(), std::size(Lookups));
+    double map_ns = requestMap(requests);
+    report("std::map", map_ns);
+    report("HeaderList", requestList(requests), map_ns);
+
+    std::printf("response headers: build and serialise\n");
+    map_ns = responseMap();
+    report("std::map, ostringstream", map_ns);
+    report("HeaderList, serializeHead", responseList(), map_ns);
+    return 0;
+}
@@ -0,0 +1,144 @@
+#include "Check.h"
+#include "HttpConditional.h"
+#include "HttpDate.h"
+#include "HttpRequest.h"
+
+#include <string>
+
+namespace {
+    // Sun, 06 Nov 1994 08:49:37 GMT
+    constexpr std::time_t example_time = 784111777;
+
+    void testHttpDate() {
+        CHECK(formatHttpDate(example_time) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        CHECK(formatHttpDate(0) == "Thu, 01 Jan 1970 00:00:00 GMT");
+
+        CHECK(parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT") == example_time);
+        CHECK(parseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT") == example_time);
+        CHECK(parseHttpDate("Sun Nov  6 08:49:37 1994") == example_time);
+        CHECK(parseHttpDate(formatHttpDate(1700000000)) == 1700000000);
+
+        CHECK(!parseHttpDate(""));
+        CHECK(!parseHttpDate("yesterday"));
+        CHECK(!parseHttpDate("Sun, 06 Nov 1994 08:49:37 PST"));
+        CHECK(!parseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT"));
+        CHECK(!parseHttpDate("Sun, 06 Nov 1994 25:49:37 GMT"));
+        CHECK(!parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT trailing"));
+    }
+
+    void testFileETag() {
+        struct stat st{};
+        st.st_ino = 0x1234;
+        st.st_size = 0xff;
+        st.st_mtim.tv_sec = 1;
+        st.st_mtim.tv_nsec = 5;
+        CHECK(fileETag(st) == "\"1234-ff-3b9aca05\"");
+        CHECK(fileETag(st, "gzip") == "\"1234-ff-3b9aca05-gzip\"");
+
+        // Any of inode, size or time changes it, down to the nanosecond
+        struct stat touched = st;
+        touched.st_mtim.tv_nsec = 6;
+        CHECK(fileETag(touched) != fileETag(st));
+        struct stat grown = st;
+        grown.st_size = 0x100;
+        CHECK(fileETag(grown) != fileETag(st));
+        struct stat replaced = st;
+        replaced.st_ino = 0x1235;
+        CHECK(fileETag(replaced) != fileETag(st));
+    }
+
+    void testETagVariant() {
+        CHECK(etagVariant("\"abc\"", "gzip") == "\"abc-gzip\"");
+        CHECK(etagVariant("W/\"abc\"", "br") == "W/\"abc-br\"");
+        CHECK(etagVariant("", "gzip").empty());
+        CHECK(etagVariant("unquoted", "gzip") == "unquoted");
+    }
+
+    void testListMatches() {
+        CHECK(etagListMatches("\"a\"", "\"a\""));
+        CHECK(etagListMatches("\"x\", \"a\"", "\"a\""));
+        CHECK(etagListMatches("\"x\",\"a\"", "\"a\""));
+        CHECK(etagListMatches("*", "\"a\""));
+        CHECK(!etagListMatches("\"b\"", "\"a\""));
+        CHECK(!etagListMatches("", "\"a\""));
+        CHECK(!etagListMatches("a", "\"a\""));
+        CHECK(!etagListMatches("\"a", "\"a\""));
+
+        // Weak comparison on either side
+        CHECK(etagListMatches("W/\"a\"", "\"a\""));
+        CHECK(etagListMatches("\"a\"", "W/\"a\""));
+        // Commas inside a tag don't split it
+        CHECK(etagListMatches("\"x,y\", \"a\"", "\"a\""));
+        CHECK(!etagListMatches("\"x,\"a\"\"", "\"a\""));
+        // A variant's tag doesn't match the identity tag, or the other way round
+        CHECK(!etagListMatches("\"abc-gzip\"", "\"abc\""));
+        CHECK(!etagListMatches("\"abc\"", "\"abc-gzip\""));
+    }
+
+    bool notModified(const std::string& method, const std::string& headers, std::string_view etag, std::time_t modified) {
+        std::string text = method + " /file HTTP/1.1\r\n" + headers + "\r\n";
+        HttpRequestParser parser(8192);
+        if (parser.parse(text) != HttpRequestParser::Status::Complete) {
+            CHECK(false);
+            return false;
+        }
+        HttpRequest request;
+        parser.build(request, text);
+        return isNotModified(request, etag, modified);
+    }
+
+    void testIsNotModified() {
+        const std::string etag = "\"e1\"";
+        const std::string date = formatHttpDate(example_time);
+
+        CHECK(!notModified("GET", "", etag, example_time));
+        CHECK(notModified("GET", "If-None-Match: \"e1\"\r\n", etag, example_time));
+        CHECK(notModified("HEAD", "If-None-Match: \"e0\", \"e1\"\r\n", etag, example_time));
+        CHECK(!notModified("GET", "If-None-Match: \"e0\"\r\n", etag, example_time));
+        CHECK(notModified("GET", "If-None-Match: *\r\n", etag, example_time));
+
+        // Only GET and HEAD get a 304
+        CHECK(!notModified("POST", "If-None-Match: \"e1\"\r\n", etag, example_time));
+        CHECK(!notModified("DELETE", "If-None-Match: *\r\n", etag, example_time));
+
+        CHECK(notModified("GET", "If-Modified-Since: " + date + "\r\n", etag, example_time));
+        CHECK(notModified("GET", "If-Modified-Since: " + date + "\r\n", etag, example_time - 60));
+        CHECK(!notModified("GET", "If-Modified-Since: " + date + "\r\n", etag, example_time + 1));
+        CHECK(!notModified("GET", "If-Modified-Since: not a date\r\n", etag, example_time));
+
+        // If-None-Match decides on its own when present, even against a date that
+        // would have matched
+        CHECK(!notModified("GET", "If-None-Match: \"e0\"\r\nIf-Modified-Since: " + date + "\r\n", etag, example_time));
+        CHECK(notModified("GET", "If-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT\r\nIf-None-Match: \"e1\"\r\n",
+            etag, example_time));
+    }
+
+    std::string revalidated(const std::string& headers, std::string_view etag, std::string_view recoded) {
+        std::string text = "GET /file HTTP/1.1\r\n" + headers + "\r\n";
+        HttpRequestParser parser(8192);
+        CHECK(parser.parse(text) == HttpRequestParser::Status::Complete);
+        HttpRequest request;
+        parser.build(request, text);
+        return std::string(revalidatedETag(request, etag, recoded));
+    }
+
+    void testRevalidatedETag() {
+        CHECK(revalidated("If-None-Match: \"e1-gzip\"\r\n", "\"e1\"", "\"e1-gzip\"") == "\"e1-gzip\"");
+        CHECK(revalidated("If-None-Match: \"e1\"\r\n", "\"e1\"", "\"e1-gzip\"") == "\"e1\"");
+        CHECK(revalidated("If-None-Match: *\r\n", "\"e1\"", "\"e1-gzip\"") == "\"e1\"");
+        CHECK(revalidated("If-None-Match: \"e0-gzip\"\r\n", "\"e1\"", "\"e1-gzip\"") == "\"e1\"");
+        CHECK(revalidated("", "\"e1\"", "\"e1-gzip\"") == "\"e1\"");
+        // Not compressed on the way out: only the identity tag is current
+        CHECK(revalidated("If-None-Match: \"e1-gzip\"\r\n", "\"e1\"", "") == "\"e1\"");
+    }
+}
+
+int main() {
+    testHttpDate();
+    testFileETag();
+    testETagVariant();
+    testListMatches();
+    testIsNotModified();
+    testRevalidatedETag();
+    return checkFailures();
+}
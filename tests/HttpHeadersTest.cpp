@@ -0,0 +1,107 @@
+#include "Check.h"
+#include "HttpHeaders.h"
+
+#include <cctype>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+    void testInterning() {
+        for (int i = 1; i <= static_cast<int>(HeaderId::XXssProtection); ++i) {
+            HeaderId id = static_cast<HeaderId>(i);
+            std::string name(headerName(id));
+            CHECK(headerId(name) == id);
+            for (char& c : name) {
+                c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+            }
+            CHECK(headerId(name) == id);
+        }
+        CHECK(headerId("X-Not-Interned") == HeaderId::Other);
+        CHECK(headerId("Content-Lengt") == HeaderId::Other);
+        CHECK(headerId("") == HeaderId::Other);
+        CHECK(headerNameEquals("content-TYPE", "Content-Type"));
+        CHECK(!headerNameEquals("Content-Type", "Content-Typo"));
+    }
+
+    void testLookup() {
+        HeaderList<std::string_view> headers;
+        headers.add(headerId("host"), "host", "example.com");
+        headers.add(HeaderId::Other, "X-Trace", "1");
+        headers.add(HeaderId::Other, "x-trace", "2");
+
+        CHECK(headers.size() == 3);
+        CHECK(headers.get(HeaderId::Host) != nullptr && *headers.get(HeaderId::Host) == "example.com");
+        CHECK(headers.get("HOST") != nullptr && *headers.get("HOST") == "example.com");
+        // Repeated headers are kept; lookups see the first
+        CHECK(headers.get("X-TRACE") != nullptr && *headers.get("X-TRACE") == "1");
+        CHECK(!headers.contains(HeaderId::Range));
+        CHECK(!headers.contains("X-Missing"));
+    }
+
+    void testSet() {
+        HeaderList<HeaderValue> headers;
+        headers.set(HeaderId::ContentType, "text/plain");
+        headers.set("content-type", std::string("text/html"));
+        headers.set("X-Custom", "a");
+        headers.set("x-custom", "b");
+
+        CHECK(headers.size() == 2);
+        CHECK(headers.get(HeaderId::ContentType)->view() == "text/html");
+        CHECK(headers.get("X-Custom")->view() == "b");
+        // Interned names get their canonical spelling on the wire
+        CHECK(headers.begin()->name == "Content-Type");
+    }
+
+    // Past InlineCapacity the list moves to the heap without losing order or entries.
+    void testOverflow() {
+        HeaderList<HeaderValue> headers;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < HeaderList<HeaderValue>::InlineCapacity * 3; ++i) {
+            names.push_back("X-Header-" + std::to_string(i));
+        }
+        for (size_t i = 0; i < names.size(); ++i) {
+            headers.add(HeaderId::Other, names[i], std::to_string(i));
+        }
+
+        CHECK(headers.size() == names.size());
+        size_t index = 0;
+        for (const auto& entry : headers) {
+            CHECK(entry.name == names[index]);
+            CHECK(entry.value.view() == std::to_string(index));
+            ++index;
+        }
+        CHECK(headers.get("x-header-40")->view() == "40");
+
+        headers.clear();
+        CHECK(headers.empty());
+        headers.add(HeaderId::Server, "Server", "test");
+        CHECK(headers.get(HeaderId::Server)->view() == "test");
+    }
+
+    void testHeaderValue() {
+        static const char literal[] = "literal";
+        HeaderValue from_literal(literal);
+        CHECK(from_literal.view().data() == literal);
+
+        HeaderValue owned(std::string("owned"));
+        HeaderValue copy = owned;
+        CHECK(copy.view() == "owned");
+        CHECK(copy.view().data() != owned.view().data());
+        CHECK(HeaderValue().view().empty());
+
+        std::string text = "timeout=5, max=99";
+        HeaderValue borrowed = HeaderValue::borrowed(text);
+        CHECK(borrowed.view().data() == text.data());
+        CHECK(HeaderValue(borrowed).view().data() == text.data());
+    }
+}
+
+int main() {
+    testInterning();
+    testLookup();
+    testSet();
+    testOverflow();
+    testHeaderValue();
+    return checkFailures();
+}
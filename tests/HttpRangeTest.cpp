@@ -0,0 +1,99 @@
+#include "Check.h"
+#include "HttpRange.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+    // "first-last,..." for the ranges, "ignore" for nullopt, "" for unsatisfiable.
+    std::string ranges(std::string_view header, uint64_t size) {
+        std::optional<std::vector<ByteRange>> parsed = parseRange(header, size);
+        if (!parsed) {
+            return "ignore";
+        }
+        std::string text;
+        for (const ByteRange& range : *parsed) {
+            if (!text.empty()) {
+                text += ',';
+            }
+            text += std::to_string(range.first) + "-" + std::to_string(range.last());
+        }
+        return text;
+    }
+
+    void testSingleRanges() {
+        CHECK(ranges("bytes=0-99", 1000) == "0-99");
+        CHECK(ranges("bytes=500-", 1000) == "500-999");
+        CHECK(ranges("bytes=-100", 1000) == "900-999");
+        CHECK(ranges("bytes=0-0", 1000) == "0-0");
+        CHECK(ranges("bytes=999-999", 1000) == "999-999");
+        CHECK(ranges(" bytes=10-19 ", 1000) == "10-19");
+
+        // Clamped to the end of the file
+        CHECK(ranges("bytes=900-5000", 1000) == "900-999");
+        CHECK(ranges("bytes=-5000", 1000) == "0-999");
+        CHECK(ranges("bytes=0-18446744073709551615", 10) == "0-9");
+    }
+
+    void testUnsatisfiable() {
+        CHECK(ranges("bytes=1000-", 1000) == "");
+        CHECK(ranges("bytes=1000-2000", 1000) == "");
+        CHECK(ranges("bytes=-0", 1000) == "");
+        CHECK(ranges("bytes=0-", 0) == "");
+        CHECK(ranges("bytes=-10", 0) == "");
+        // One satisfiable range is enough
+        CHECK(ranges("bytes=2000-3000, 5-9", 1000) == "5-9");
+    }
+
+    void testIgnored() {
+        CHECK(ranges("", 1000) == "ignore");
+        CHECK(ranges("items=0-10", 1000) == "ignore");
+        CHECK(ranges("Bytes=0-10", 1000) == "ignore");
+        CHECK(ranges("bytes=", 1000) == "ignore");
+        CHECK(ranges("bytes=,,", 1000) == "ignore");
+        CHECK(ranges("bytes=10", 1000) == "ignore");
+        CHECK(ranges("bytes=-", 1000) == "ignore");
+        CHECK(ranges("bytes=20-10", 1000) == "ignore");
+        CHECK(ranges("bytes=+1-10", 1000) == "ignore");
+        CHECK(ranges("bytes=1--10", 1000) == "ignore");
+        CHECK(ranges("bytes=0x10-20", 1000) == "ignore");
+        CHECK(ranges("bytes=0-10, junk", 1000) == "ignore");
+        CHECK(ranges("bytes=99999999999999999999-", 1000) == "ignore");
+    }
+
+    void testMultipleRanges() {
+        CHECK(ranges("bytes=0-9, 20-29", 1000) == "0-9,20-29");
+        // Sorted into file order
+        CHECK(ranges("bytes=-10,0-9", 1000) == "0-9,990-999");
+        // Overlapping and adjacent ranges merge; a gap of one byte doesn't
+        CHECK(ranges("bytes=0-9,5-14", 1000) == "0-14");
+        CHECK(ranges("bytes=0-9,10-19", 1000) == "0-19");
+        CHECK(ranges("bytes=0-9,11-19", 1000) == "0-9,11-19");
+        CHECK(ranges("bytes=0-99,10-19", 1000) == "0-99");
+        CHECK(ranges("bytes=0-,-10", 1000) == "0-999");
+        // Empty list elements are skipped
+        CHECK(ranges("bytes=, 0-1 ,,4-5,", 1000) == "0-1,4-5");
+    }
+
+    void testRangeLimit() {
+        std::string header = "bytes=";
+        for (size_t i = 0; i < MaxByteRanges; ++i) {
+            header += std::to_string(i * 10) + "-" + std::to_string(i * 10 + 1) + ",";
+        }
+        std::optional<std::vector<ByteRange>> parsed = parseRange(header, 1000);
+        CHECK(parsed && parsed->size() == MaxByteRanges);
+
+        header += "900-901";
+        CHECK(ranges(header, 1000) == "ignore");
+    }
+}
+
+int main() {
+    testSingleRanges();
+    testUnsatisfiable();
+    testIgnored();
+    testMultipleRanges();
+    testRangeLimit();
+    return checkFailures();
+}
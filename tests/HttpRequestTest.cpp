@@ -0,0 +1,236 @@
+#include "Check.h"
+#include "HttpRequest.h"
+
+#include <string>
+#include <string_view>
+
+namespace {
+    using Status = HttpRequestParser::Status;
+
+    // Feeds the request to a fresh parser in one piece.
+    Status parseWhole(std::string_view text, size_t max_size = 8192) {
+        HttpRequestParser parser(max_size);
+        return parser.parse(text);
+    }
+
+    void testCompleteRequest() {
+        std::string text =
+            "POST /api/upload?name=a%20b&x=1 HTTP/1.1\r\n"
+            "Host: example.com\r\n"
+            "content-length: 5\r\n"
+            "X-Custom:  spaced value \t\r\n"
+            "\r\n"
+            "helloGET / HTTP/1.1\r\n\r\n";
+
+        HttpRequestParser parser(8192);
+        CHECK(parser.parse(text) == Status::Complete);
+
+        HttpRequest request;
+        parser.build(request, text);
+        CHECK(request.method == "POST");
+        CHECK(request.path == "/api/upload");
+        CHECK(request.query_string == "name=a%20b&x=1");
+        CHECK(request.version == "HTTP/1.1");
+        CHECK(request.header(HeaderId::Host) == "example.com");
+        CHECK(request.header("Content-Length") == "5");
+        CHECK(request.header("x-custom") == "spaced value");
+        CHECK(request.body == "hello");
+
+        // Views, not copies: everything points into the caller's buffer
+        CHECK(request.method.data() == text.data());
+        CHECK(request.body.data() == text.data() + text.find("hello"));
+
+        // The next pipelined request starts right after this one
+        CHECK(text.substr(parser.requestSize()) == "GET / HTTP/1.1\r\n\r\n");
+        parser.reset();
+        std::string_view next = std::string_view(text).substr(request.body.data() + request.body.size() - text.data());
+        CHECK(parser.parse(next) == Status::Complete);
+        parser.build(request, next);
+        CHECK(request.method == "GET");
+        CHECK(request.path == "/");
+        CHECK(request.body.empty());
+    }
+
+    // One byte per call must give the same request as all of it at once, with the
+    // right "need more" status along the way.
+    void testByteAtATime() {
+        std::string text =
+            "PUT /file HTTP/1.0\r\n"
+            "Content-Length: 3\r\n"
+            "Connection: keep-alive\r\n"
+            "\r\n"
+            "abc";
+        size_t header_end = text.find("\r\n\r\n") + 4;
+
+        HttpRequestParser parser(8192);
+        for (size_t size = 1; size < text.size(); ++size) {
+            Status status = parser.parse(std::string_view(text).substr(0, size));
+            CHECK(status == (size < header_end ? Status::NeedHeaders : Status::NeedBody));
+        }
+        CHECK(parser.parse(text) == Status::Complete);
+
+        HttpRequest request;
+        parser.build(request, text);
+        CHECK(request.method == "PUT");
+        CHECK(request.version == "HTTP/1.0");
+        CHECK(request.body == "abc");
+        CHECK(request.wantsKeepAlive());
+    }
+
+    // The buffer may move between calls (the receive buffer grows); only offsets are
+    // kept, so the views come from wherever the bytes are now.
+    void testBufferMoves() {
+        std::string first = "GET /moved HTTP/1.1\r\nHo";
+        HttpRequestParser parser(8192);
+        CHECK(parser.parse(first) == Status::NeedHeaders);
+
+        std::string second = first + "st: h\r\n\r\n";
+        CHECK(parser.parse(second) == Status::Complete);
+        HttpRequest request;
+        parser.build(request, second);
+        CHECK(request.path == "/moved");
+        CHECK(request.header(HeaderId::Host) == "h");
+        CHECK(request.path.data() == second.data() + 4);
+    }
+
+    void testLineEndings() {
+        // Bare LF, and blank lines ahead of the request line
+        std::string text = "\r\n\nGET /lf HTTP/1.1\nHost: x\n\n";
+        HttpRequestParser parser(8192);
+        CHECK(parser.parse(text) == Status::Complete);
+        HttpRequest request;
+        parser.build(request, text);
+        CHECK(request.path == "/lf");
+        CHECK(request.header(HeaderId::Host) == "x");
+        CHECK(parser.requestSize() == text.size());
+    }
+
+    void testInvalid() {
+        const char* requests[] = {
+            "GET\r\n\r\n",
+            "GET /\r\n\r\n",
+            "GET  / HTTP/1.1\r\n\r\n",
+            "GET / HTTP/1.1 extra\r\n\r\n",
+            "GET / HTTP/2.0\r\n\r\n",
+            "GET / HTTP/1.x\r\n\r\n",
+            "G(T / HTTP/1.1\r\n\r\n",
+            "GET /a\x01 HTTP/1.1\r\n\r\n",
+            "GET / HTTP/1.1\r\nNo colon\r\n\r\n",
+            "GET / HTTP/1.1\r\nName : value\r\n\r\n",
+            "GET / HTTP/1.1\r\n: value\r\n\r\n",
+            "GET / HTTP/1.1\r\n folded: value\r\n\r\n",
+            "GET / HTTP/1.1\r\nX: a\x7f b\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: 1, 1\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length:\r\n\r\n",
+            "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab",
+            "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n",
+        };
+        for (const char* text : requests) {
+            if (parseWhole(text) != Status::Invalid) {
+                std::fprintf(stderr, "  accepted: %s\n", text);
+                CHECK(false);
+            }
+        }
+
+        // A repeated Content-Length that agrees is fine
+        CHECK(parseWhole("POST / HTTP/1.1\r\nContent-Length: 2\r\ncontent-length: 2\r\n\r\nab") == Status::Complete);
+        // Tabs are allowed in values
+        CHECK(parseWhole("GET / HTTP/1.1\r\nX: a\tb\r\n\r\n") == Status::Complete);
+    }
+
+    void testTooLarge() {
+        // Headers that never end
+        std::string endless = "GET / HTTP/1.1\r\nX: " + std::string(200, 'a');
+        CHECK(parseWhole(endless, 64) == Status::TooLarge);
+
+        // A single line past the limit, even if it ends later in the buffer
+        std::string long_line = "GET /" + std::string(100, 'a') + " HTTP/1.1\r\n\r\n";
+        CHECK(parseWhole(long_line, 64) == Status::TooLarge);
+
+        // Headers that fit, with a body that doesn't: refused before it arrives
+        CHECK(parseWhole("POST / HTTP/1.1\r\nContent-Length: 100\r\n\r\n", 64) == Status::TooLarge);
+        CHECK(parseWhole("POST / HTTP/1.1\r\nContent-Length: 99999999999999999999\r\n\r\n", 64) == Status::Invalid);
+
+        // Right at the limit is still fine
+        std::string exact = "POST / HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+        CHECK(parseWhole(exact, exact.size()) == Status::Complete);
+        CHECK(parseWhole(exact, exact.size() - 1) == Status::TooLarge);
+    }
+
+    void testKeepAlive() {
+        auto keepAlive = [](std::string text) {
+            HttpRequestParser parser(8192);
+            parser.parse(text);
+            HttpRequest request;
+            parser.build(request, text);
+            return request.wantsKeepAlive();
+        };
+        CHECK(keepAlive("GET / HTTP/1.1\r\n\r\n"));
+        CHECK(!keepAlive("GET / HTTP/1.1\r\nConnection: close\r\n\r\n"));
+        CHECK(!keepAlive("GET / HTTP/1.0\r\n\r\n"));
+        CHECK(keepAlive("GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n"));
+    }
+
+    std::string decoded(std::string text, bool plus_is_space) {
+        text.resize(percentDecode(text.data(), text.size(), plus_is_space));
+        return text;
+    }
+
+    void testPercentDecode() {
+        CHECK(decoded("plain", true) == "plain");
+        CHECK(decoded("a%20b%2Fc", false) == "a b/c");
+        CHECK(decoded("%e2%82%ac", false) == "\xe2\x82\xac");
+        CHECK(decoded("a+b", true) == "a b");
+        CHECK(decoded("a+b", false) == "a+b");
+        CHECK(decoded("%2B+", true) == "+ ");
+        // Malformed escapes are kept as they are
+        CHECK(decoded("100%", false) == "100%");
+        CHECK(decoded("%4", false) == "%4");
+        CHECK(decoded("%zz%41", false) == "%zzA");
+        CHECK(decoded("%%41", false) == "%A");
+        CHECK(decoded("%00", false) == std::string(1, '\0'));
+        CHECK(decoded("", true).empty());
+    }
+
+    void testQueryView() {
+        QueryView query("name=my%20file.txt&offset=1024&empty=&flag&name=second&n=%31%32&bad=12x&neg=-5");
+        CHECK(query.raw("name") == "my%20file.txt");
+        CHECK(query.get<std::string>("name") == "my file.txt");
+        CHECK(query.get<int>("offset") == 1024);
+        CHECK(query.get<std::string>("empty") == "");
+        CHECK(!query.get<int>("empty"));
+        // A name without '=' has no value
+        CHECK(!query.raw("flag"));
+        CHECK(!query.raw("missing"));
+        CHECK(!query.raw("nam"));
+        // Escaped digits decode before conversion
+        CHECK(query.get<int>("n") == 12);
+        CHECK(!query.get<int>("bad"));
+        CHECK(query.get<long>("neg") == -5);
+        CHECK(!query.get<unsigned>("neg"));
+        CHECK(!QueryView("n=99999999999").get<int>("n"));
+        CHECK(!QueryView("n=" + std::string(40, '1')).get<long long>("n"));
+        CHECK(!QueryView("").raw("name"));
+
+        HttpRequestParser parser(8192);
+        std::string text = "GET /api/download?file=a%2Bb+c.txt HTTP/1.1\r\n\r\n";
+        CHECK(parser.parse(text) == Status::Complete);
+        HttpRequest request;
+        parser.build(request, text);
+        CHECK(request.query<std::string>("file") == "a+b c.txt");
+    }
+}
+
+int main() {
+    testCompleteRequest();
+    testByteAtATime();
+    testBufferMoves();
+    testLineEndings();
+    testInvalid();
+    testTooLarge();
+    testKeepAlive();
+    testPercentDecode();
+    testQueryView();
+    return checkFailures();
+}
@@ -0,0 +1,125 @@
+#include "Check.h"
+
+// Built into this test rather than linked, so every kernel the CPU supports can be
+// checked against the scalar one, not just the one picked at startup.
+#include "HttpScan.cpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    using Finder = const char* (*)(const char*, const char*);
+
+    struct Variant {
+        const char* name;
+        Finder find_non_token;
+        Finder find_control;
+    };
+
+    std::vector<Variant> supportedVariants() {
+        std::vector<Variant> variants{ { "scalar", findNonTokenScalar, findControlScalar } };
+#ifdef HTTP_SCAN_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) {
+            variants.push_back({ "sse4.2", findNonTokenSse42, findControlSse42 });
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) {
+            variants.push_back({ "avx2", findNonTokenAvx2, findControlAvx2 });
+        }
+#endif
+        variants.push_back({ "dispatched", HttpScan::findNonToken, HttpScan::findControl });
+        return variants;
+    }
+
+    // Straight from the definitions, independent of the tables the kernels use.
+    const char* referenceNonToken(const char* begin, const char* end) {
+        const std::string_view specials = "!#$%&'*+-.^_`|~";
+        for (; begin != end; ++begin) {
+            unsigned char c = static_cast<unsigned char>(*begin);
+            bool token = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                (c != 0 && specials.find(static_cast<char>(c)) != std::string_view::npos);
+            if (!token) {
+                break;
+            }
+        }
+        return begin;
+    }
+
+    const char* referenceControl(const char* begin, const char* end) {
+        for (; begin != end; ++begin) {
+            unsigned char c = static_cast<unsigned char>(*begin);
+            if ((c < 0x20 && c != '\t') || c == 0x7f) {
+                break;
+            }
+        }
+        return begin;
+    }
+
+    // Every byte value at every position of buffers up to 80 bytes long (covering the
+    // 16- and 32-byte blocks and the tails behind them), in a token/printable run.
+    void testEveryByteEverywhere(const Variant& variant) {
+        for (size_t size = 1; size <= 80; ++size) {
+            for (size_t at = 0; at < size; ++at) {
+                for (int byte = 0; byte < 256; ++byte) {
+                    std::string token_run(size, 'a');
+                    token_run[at] = static_cast<char>(byte);
+                    const char* begin = token_run.data();
+                    const char* end = begin + size;
+                    if (variant.find_non_token(begin, end) != referenceNonToken(begin, end)) {
+                        std::fprintf(stderr, "  %s findNonToken: byte 0x%02x at %zu of %zu\n", variant.name, byte, at, size);
+                        CHECK(false);
+                        return;
+                    }
+
+                    std::string printable_run(size, ' ');
+                    printable_run[at] = static_cast<char>(byte);
+                    begin = printable_run.data();
+                    end = begin + size;
+                    if (variant.find_control(begin, end) != referenceControl(begin, end)) {
+                        std::fprintf(stderr, "  %s findControl: byte 0x%02x at %zu of %zu\n", variant.name, byte, at, size);
+                        CHECK(false);
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    // Realistic header lines at every alignment, plus random noise.
+    void testMixedInput(const Variant& variant) {
+        std::string headers =
+            "Accept-Encoding: gzip, deflate, br\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+            "X-Forwarded-For: 10.0.0.1\r\nIf-None-Match: \"abc\", W/\"def\"\tx\r\n";
+        std::mt19937 random(12345);
+        std::string noise(4096, '\0');
+        for (char& c : noise) {
+            c = static_cast<char>(random() % 0x60 + 0x20);
+        }
+
+        for (const std::string* text : { &headers, &noise }) {
+            for (size_t offset = 0; offset < text->size(); ++offset) {
+                const char* begin = text->data() + offset;
+                const char* end = text->data() + text->size();
+                CHECK(variant.find_non_token(begin, end) == referenceNonToken(begin, end));
+                CHECK(variant.find_control(begin, end) == referenceControl(begin, end));
+            }
+        }
+    }
+
+    void testEmpty(const Variant& variant) {
+        const char* text = "x";
+        CHECK(variant.find_non_token(text, text) == text);
+        CHECK(variant.find_control(text, text) == text);
+    }
+}
+
+int main() {
+    for (const Variant& variant : supportedVariants()) {
+        std::printf("%s\n", variant.name);
+        testEmpty(variant);
+        testEveryByteEverywhere(variant);
+        testMixedInput(variant);
+    }
+    return checkFailures();
+}
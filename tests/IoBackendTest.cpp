@@ -0,0 +1,253 @@
+#include "Check.h"
+#include "Net/IoBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+    // Accepts one connection and answers it with whatever respond() queues; records
+    // how the backend reported the send. Stops the backend once the send is done,
+    // unless the test has more to wait for.
+    class OneShot : public IoAcceptor, public IoChannel {
+    public:
+        IoBackend& backend;
+        std::function<void(int fd)> respond;
+        int fd = -1;
+        bool completed = false;
+        bool stop_on_complete = true;
+        int error = 0;
+
+        OneShot(IoBackend& io, std::function<void(int fd)> queue) : backend(io), respond(std::move(queue)) {}
+
+        IoChannel* onAccept(int client, std::string) override {
+            fd = client;
+            backend.post([this] { respond(fd); });
+            return this;
+        }
+
+        void onReceive(const char*, size_t) override {}
+        void onEndOfStream() override {}
+        void onSendProgress() override {}
+
+        void onError(int code) override {
+            error = code;
+            backend.stop();
+        }
+
+        void onSendComplete() override {
+            completed = true;
+            if (stop_on_complete) {
+                backend.stop();
+            }
+        }
+    };
+
+    int listenLoopback(uint16_t& port) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), length) != 0 || ::listen(fd, 8) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+            std::perror("listen");
+            std::exit(1);
+        }
+        port = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    // Connects, reads until the peer closes or expected bytes arrived.
+    std::string fetch(uint16_t port, size_t expected) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        timeval timeout{ 5, 0 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+        std::string received;
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            char buffer[4096];
+            ssize_t n = 0;
+            while (received.size() < expected && (n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+                received.append(buffer, static_cast<size_t>(n));
+            }
+        }
+        ::close(fd);
+        return received;
+    }
+
+    struct Delivery {
+        bool completed = false;
+        bool settled = false;   // Before the backend and its sockets are torn down
+        int error = 0;
+        std::string received;
+    };
+
+    // Runs a backend until the one connection it accepts has had what queue() puts on
+    // it sent, and settled() if given holds, and reads expected bytes of it on the
+    // client side.
+    Delivery deliver(const char* backend_name, size_t expected, std::function<void(IoBackend&, int fd)> queue,
+            std::function<bool()> settled = nullptr) {
+        std::string fallback;
+        std::unique_ptr<IoBackend> backend = createIoBackend(backend_name, fallback);
+        if (!fallback.empty()) {
+            std::printf("%s unavailable (%s), tested %s instead\n", backend_name, fallback.c_str(), backend->name());
+        }
+
+        OneShot shot(*backend, [&](int fd) { queue(*backend, fd); });
+        shot.stop_on_complete = !settled;
+
+        uint16_t port = 0;
+        int listen_fd = listenLoopback(port);
+        backend->listen(listen_fd, false, &shot);
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        backend->setTick(std::chrono::milliseconds(10), [&](uint64_t) {
+            if (std::chrono::steady_clock::now() > deadline || (shot.completed && settled())) {
+                backend->stop();
+            }
+        });
+
+        Delivery delivery;
+        std::thread client([&] { delivery.received = fetch(port, expected); });
+        backend->run();
+        client.join();
+        delivery.completed = shot.completed;
+        delivery.settled = !settled || settled();
+        delivery.error = shot.error;
+
+        backend->stopListening();
+        if (shot.fd >= 0) {
+            backend->close(shot.fd);
+        }
+        ::close(listen_fd);
+        return delivery;
+    }
+
+    int temporaryFile(const std::string& content) {
+        char path[] = "/tmp/iobackend-test-XXXXXX";
+        int file_fd = mkstemp(path);
+        CHECK(file_fd >= 0);
+        unlink(path);
+        CHECK(write(file_fd, content.data(), content.size()) == static_cast<ssize_t>(content.size()));
+        return file_fd;
+    }
+
+    // An empty file between two buffers, as a 0-byte download queues it: the send
+    // must complete, not fail with EIO, and the connection stays usable.
+    void testEmptyFile(const char* backend_name) {
+        int file_fd = temporaryFile("");
+        Delivery delivery = deliver(backend_name, 9, [&](IoBackend& backend, int fd) {
+            backend.send(fd, "head;", 5);
+            backend.sendFile(fd, file_fd, 0, 0);
+            backend.send(fd, "tail", 4);
+        });
+
+        CHECK(delivery.completed);
+        CHECK(delivery.error == 0);
+        CHECK(delivery.received == "head;tail");
+        ::close(file_fd);
+    }
+
+    // A file sendfile() refuses (procfs has no splice support) still goes out, read
+    // and copied, and so does a regular file queued after it on the same connection.
+    void testRefusedFile(const char* backend_name) {
+        int proc_fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+        CHECK(proc_fd >= 0);
+        int file_fd = temporaryFile("regular file");
+        Delivery delivery = deliver(backend_name, 5 + 16 + 12, [&](IoBackend& backend, int fd) {
+            backend.send(fd, "head;", 5);
+            backend.sendFile(fd, proc_fd, 0, 16);
+            backend.sendFile(fd, file_fd, 0, 12);
+        });
+
+        CHECK(delivery.completed);
+        CHECK(delivery.error == 0);
+        CHECK(delivery.received.size() == 5 + 16 + 12);
+        CHECK(delivery.received.starts_with("head;Name:"));
+        CHECK(delivery.received.ends_with("regular file"));
+        ::close(proc_fd);
+        ::close(file_fd);
+    }
+
+    // Zero-copy memory is let go as the kernel reports each send done, while the
+    // connection is still open, not only once every send on it is done.
+    void testZeroCopyRelease(const char* backend_name) {
+        constexpr size_t Sends = 8;
+        constexpr size_t Size = 64 * 1024;
+        std::vector<std::weak_ptr<const std::string>> owners;
+        auto released = [&] {
+            return std::all_of(owners.begin(), owners.end(), [](const auto& owner) { return owner.expired(); });
+        };
+        Delivery delivery = deliver(backend_name, Sends * Size, [&](IoBackend& backend, int fd) {
+            for (size_t i = 0; i < Sends; ++i) {
+                auto buffer = std::make_shared<const std::string>(Size, static_cast<char>('a' + i));
+                owners.push_back(buffer);
+                backend.sendZeroCopy(fd, buffer->data(), buffer->size(), buffer);
+            }
+        }, released);
+
+        CHECK(delivery.completed);
+        CHECK(delivery.error == 0);
+        CHECK(delivery.received.size() == Sends * Size);
+        CHECK(delivery.received.front() == 'a' && delivery.received.back() == 'a' + Sends - 1);
+        CHECK(delivery.settled);
+    }
+
+    // A loop that blocks past several intervals is told how many it missed, so the
+    // ticks add up to the time that has passed.
+    void testTickCatchesUp(const char* backend_name) {
+        std::string fallback;
+        std::unique_ptr<IoBackend> backend = createIoBackend(backend_name, fallback);
+
+        constexpr auto interval = std::chrono::milliseconds(10);
+        int calls = 0;
+        uint64_t ticks = 0;
+        auto started = std::chrono::steady_clock::now();
+        auto last_call = started;
+        backend->setTick(interval, [&](uint64_t count) {
+            last_call = std::chrono::steady_clock::now();
+            ++calls;
+            ticks += count;
+            if (calls % 2 == 1) {
+                std::this_thread::sleep_for(interval * 6);
+            }
+            if (std::chrono::steady_clock::now() - started > std::chrono::milliseconds(300)) {
+                backend->stop();
+            }
+        });
+        backend->run();
+
+        uint64_t expected = static_cast<uint64_t>((last_call - started) / interval);
+        CHECK(ticks + 2 >= expected);
+        CHECK(ticks <= expected);
+        CHECK(static_cast<uint64_t>(calls) < ticks / 2);
+    }
+}
+
+int main() {
+    testEmptyFile("epoll");
+    testEmptyFile("io_uring");
+    testRefusedFile("epoll");
+    testRefusedFile("io_uring");
+    testZeroCopyRelease("epoll");
+    testZeroCopyRelease("io_uring");
+    testTickCatchesUp("epoll");
+    testTickCatchesUp("io_uring");
+    return checkFailures();
+}
@@ -0,0 +1,82 @@
+#include "Bench.h"
+#include "TestServer.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Load the way the scripted sync clients make it: small /api/files and /api/download
+// calls back to back on kept-alive connections, written `depth` at a time without
+// waiting for the answers in between. Depth 1 is a client that doesn't pipeline.
+namespace {
+    // Under max_keep_alive_requests, so no connection is closed on the client mid-send
+    constexpr int RequestsPerConnection = 96;
+
+    std::string requestBatch(int depth) {
+        std::string batch;
+        for (int i = 0; i < depth; ++i) {
+            const char* target = i % 2 == 0 ? "/api/files?path=docs" : "/api/download?file=docs/a.txt";
+            batch += std::string("GET ") + target + " HTTP/1.1\r\nHost: test\r\n\r\n";
+        }
+        return batch;
+    }
+
+    // One client's share of the load: fresh connections, each used to its limit.
+    // False if any answer went missing or wasn't a 200.
+    bool runClient(uint16_t port, int depth, int connections) {
+        std::string batch = requestBatch(depth);
+        for (int c = 0; c < connections; ++c) {
+            Client client(port);
+            for (int sent = 0; sent + depth <= RequestsPerConnection; sent += depth) {
+                client.send(batch);
+                for (int i = 0; i < depth; ++i) {
+                    if (client.receive().status != 200) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Requests answered per second with `clients` connections open at once.
+    double requestsPerSecond(TestServer& server, int depth, int clients) {
+        constexpr int ConnectionsPerClient = 20;
+        std::atomic<bool> ok{ true };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int i = 0; i < clients; ++i) {
+            threads.emplace_back([&] {
+                if (!runClient(server.port(), depth, ConnectionsPerClient)) {
+                    ok = false;
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (!ok) {
+            std::printf("  depth %d: requests failed\n", depth);
+        }
+        int per_connection = RequestsPerConnection / depth * depth;
+        return clients * ConnectionsPerClient * per_connection / elapsed.count();
+    }
+}
+
+int main() {
+    for (const char* backend : { "epoll", "io_uring" }) {
+        TestServer server(backend, false);
+        for (int clients : { 1, 8 }) {
+            std::printf("%s, %d client%s\n", backend, clients, clients > 1 ? "s" : "");
+            double unpipelined = 0;
+            for (int depth : { 1, 4, 16, 32 }) {
+                double rate = requestsPerSecond(server, depth, clients);
+                unpipelined = depth == 1 ? rate : unpipelined;
+                std::printf("  depth %-3d %10.0f requests/s  %5.2fx\n", depth, rate, rate / unpipelined);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include "Bench.h"
+#include "TestServer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// New connections per second, and how long each takes, for both I/O backends and for
+// the model they replaced, with and without a crowd of idle connections held open. Each
+// connection sends one CORS preflight, whose handler does no work of its own, so what
+// is measured is the cost of taking on a connection and answering on it. Then, for the
+// two backends, how fast downloads go, which keeps file reads and sends in flight.
+namespace {
+    const std::string Preflight = "OPTIONS /api/files HTTP/1.1\r\nHost: test\r\nConnection: close\r\n\r\n";
+
+    // The accept loop as Server::start used to run it: one detached thread per client,
+    // a blocking recv() and send(), then close. The answer is canned, which only
+    // flatters it.
+    class ThreadPerConnection {
+    public:
+        ThreadPerConnection() {
+            port = freePort();
+            listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int one = 1;
+            setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            bind(listen_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            ::listen(listen_fd, SOMAXCONN);
+            acceptor = std::thread([this] { run(); });
+        }
+
+        ~ThreadPerConnection() {
+            shutdown(listen_fd, SHUT_RDWR);
+            acceptor.join();
+            ::close(listen_fd);
+        }
+
+        uint16_t port = 0;
+
+    private:
+        int listen_fd = -1;
+        std::thread acceptor;
+
+        void run() {
+            while (true) {
+                int client = accept(listen_fd, nullptr, nullptr);
+                if (client < 0) {
+                    if (errno == EINTR || errno == ECONNABORTED) {
+                        continue;
+                    }
+                    return;
+                }
+                std::thread([client] {
+                    static const char answer[] = "HTTP/1.1 204 No Content\r\nServer: RaspberryPi-FileServer/1.0\r\n\r\n";
+                    char buffer[8192];
+                    if (recv(client, buffer, sizeof(buffer), 0) > 0) {
+                        ::send(client, answer, sizeof(answer) - 1, MSG_NOSIGNAL);
+                    }
+                    ::close(client);
+                }).detach();
+            }
+        }
+    };
+
+    struct Result {
+        double connections_per_second = 0;
+        double p50_us = 0;
+        double p99_us = 0;
+        int failures = 0;
+    };
+
+    // `clients` threads open connections one after another, `per_client` each, while
+    // `idle` more sit open and silent on the server throughout.
+    Result measure(uint16_t port, int clients, int per_client, int idle) {
+        std::vector<std::unique_ptr<Client>> held;
+        for (int i = 0; i < idle; ++i) {
+            held.push_back(std::make_unique<Client>(port));
+        }
+
+        std::vector<std::vector<double>> latencies(clients);
+        std::atomic<int> failures{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int c = 0; c < clients; ++c) {
+            threads.emplace_back([&, c] {
+                for (int i = 0; i < per_client; ++i) {
+                    auto opened = std::chrono::steady_clock::now();
+                    Client client(port);
+                    client.send(Preflight);
+                    if (client.receive().status != 204) {
+                        ++failures;
+                    }
+                    latencies[c].push_back(
+                            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - opened).count());
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        std::vector<double> all;
+        for (const auto& client : latencies) {
+            all.insert(all.end(), client.begin(), client.end());
+        }
+        std::sort(all.begin(), all.end());
+        Result result;
+        result.connections_per_second = all.size() / elapsed.count();
+        result.p50_us = all[all.size() / 2];
+        result.p99_us = all[all.size() * 99 / 100];
+        result.failures = failures;
+        return result;
+    }
+
+    // Megabytes per second of 200 KB downloads, `clients` kept-alive connections at once.
+    double downloadRate(uint16_t port, int clients) {
+        constexpr int PerClient = 90;
+        std::atomic<size_t> bytes{ 0 };
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int c = 0; c < clients; ++c) {
+            threads.emplace_back([&] {
+                Client client(port);
+                for (int i = 0; i < PerClient; ++i) {
+                    bytes += client.request("GET", "/api/download?file=data.bin").body.size();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return bytes / elapsed.count() / 1e6;
+    }
+
+    void run(const char* model, uint16_t port) {
+        for (int idle : { 0, 2000 }) {
+            Result result = measure(port, 8, 500, idle);
+            std::printf("  %-22s %5d idle %10.0f connections/s  p50 %8.1f us  p99 %8.1f us%s\n", model, idle,
+                    result.connections_per_second, result.p50_us, result.p99_us,
+                    result.failures > 0 ? "  (failures)" : "");
+        }
+    }
+}
+
+int main() {
+    {
+        ThreadPerConnection server;
+        run("thread per connection", server.port);
+    }
+    for (const char* backend : { "epoll", "io_uring" }) {
+        TestServer server(backend, false);
+        run(backend, server.port());
+    }
+    for (const char* backend : { "epoll", "io_uring" }) {
+        TestServer server(backend, false);
+        for (int clients : { 1, 8 }) {
+            std::printf("  %-22s %d client%s downloading %8.0f MB/s\n", backend, clients, clients > 1 ? "s" : " ",
+                    downloadRate(server.port(), clients));
+        }
+    }
+    return 0;
+}
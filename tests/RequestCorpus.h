@@ -0,0 +1,86 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Requests as browsers, curl and the sync clients send them, headers and all, for the
+// parser benchmarks.
+inline const std::vector<std::string>& requestCorpus() {
+    static const std::vector<std::string> corpus = {
+        // Chrome loading the web interface
+        "GET / HTTP/1.1\r\n"
+        "Host: raspberrypi.local:8080\r\n"
+        "Connection: keep-alive\r\n"
+        "Cache-Control: max-age=0\r\n"
+        "sec-ch-ua: \"Chromium\";v=\"124\", \"Google Chrome\";v=\"124\", \"Not-A.Brand\";v=\"99\"\r\n"
+        "sec-ch-ua-mobile: ?0\r\n"
+        "sec-ch-ua-platform: \"Windows\"\r\n"
+        "Upgrade-Insecure-Requests: 1\r\n"
+        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) "
+        "Chrome/124.0.0.0 Safari/537.36\r\n"
+        "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,image/apng,"
+        "*/*;q=0.8,application/signed-exchange;v=b3;q=0.7\r\n"
+        "Sec-Fetch-Site: none\r\n"
+        "Sec-Fetch-Mode: navigate\r\n"
+        "Sec-Fetch-User: ?1\r\n"
+        "Sec-Fetch-Dest: document\r\n"
+        "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+        "Accept-Language: en-GB,en-US;q=0.9,en;q=0.8\r\n"
+        "If-None-Match: \"1f4-18f2c3a1b00\"\r\n"
+        "If-Modified-Since: Tue, 14 May 2024 09:12:44 GMT\r\n"
+        "\r\n",
+
+        // Firefox fetching a listing from the page's script
+        "GET /api/files?path=photos%2F2024%2Fsummer HTTP/1.1\r\n"
+        "Host: raspberrypi.local:8080\r\n"
+        "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:125.0) Gecko/20100101 Firefox/125.0\r\n"
+        "Accept: */*\r\n"
+        "Accept-Language: en-US,en;q=0.5\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Referer: http://raspberrypi.local:8080/\r\n"
+        "Connection: keep-alive\r\n"
+        "Sec-Fetch-Dest: empty\r\n"
+        "Sec-Fetch-Mode: cors\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Priority: u=4\r\n"
+        "\r\n",
+
+        // curl, as the scripts use it
+        "GET /api/download?file=backups/db-2024-05-14.tar.gz HTTP/1.1\r\n"
+        "Host: 192.168.1.20:8080\r\n"
+        "User-Agent: curl/8.5.0\r\n"
+        "Accept: */*\r\n"
+        "\r\n",
+
+        "GET /api/files?path=docs HTTP/1.1\r\n"
+        "Host: 192.168.1.20:8080\r\n"
+        "User-Agent: curl/8.5.0\r\n"
+        "Accept: */*\r\n"
+        "Range: bytes=0-1023\r\n"
+        "\r\n",
+
+        // The page's preflight before a delete, and an upload from a script
+        "OPTIONS /api/delete?file=tmp%2Fold.log HTTP/1.1\r\n"
+        "Host: raspberrypi.local:8080\r\n"
+        "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 14_4_1) AppleWebKit/605.1.15 (KHTML, like Gecko) "
+        "Version/17.4.1 Safari/605.1.15\r\n"
+        "Accept: */*\r\n"
+        "Origin: http://raspberrypi.local:8080\r\n"
+        "Access-Control-Request-Method: DELETE\r\n"
+        "Access-Control-Request-Headers: content-type\r\n"
+        "Connection: keep-alive\r\n"
+        "\r\n",
+
+        "POST /api/upload?name=notes.txt HTTP/1.1\r\n"
+        "Host: 192.168.1.20:8080\r\n"
+        "User-Agent: python-requests/2.31.0\r\n"
+        "Accept-Encoding: gzip, deflate\r\n"
+        "Accept: */*\r\n"
+        "Connection: keep-alive\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 24\r\n"
+        "\r\n"
+        "remember to rotate logs\n",
+    };
+    return corpus;
+}
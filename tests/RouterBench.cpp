@@ -0,0 +1,152 @@
+#include "Bench.h"
+#include "Router.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// API dispatch over 64 routes: the chain of string comparisons handleApiRequest used
+// to be against RouteTable, for the first route, the last, a miss and all of them in
+// turn, and RouteTable with 6 routes against 64 for the same lookups.
+namespace {
+    using Handler = int;
+
+    constexpr Route<Handler> many_routes[] = {
+        { HttpMethod::Get, "/api/files", 1 },              { HttpMethod::Get, "/api/download", 2 },
+        { HttpMethod::Post, "/api/upload", 3 },            { HttpMethod::Delete, "/api/delete", 4 },
+        { HttpMethod::Get, "/api/stats", 5 },              { HttpMethod::Get, "/api/metrics", 6 },
+        { HttpMethod::Get, "/api/files/recent", 7 },       { HttpMethod::Get, "/api/files/starred", 8 },
+        { HttpMethod::Post, "/api/files/star", 9 },        { HttpMethod::Delete, "/api/files/star", 10 },
+        { HttpMethod::Get, "/api/trash", 11 },             { HttpMethod::Post, "/api/trash/restore", 12 },
+        { HttpMethod::Delete, "/api/trash", 13 },          { HttpMethod::Post, "/api/move", 14 },
+        { HttpMethod::Post, "/api/copy", 15 },             { HttpMethod::Post, "/api/rename", 16 },
+        { HttpMethod::Post, "/api/mkdir", 17 },            { HttpMethod::Get, "/api/search", 18 },
+        { HttpMethod::Get, "/api/thumbnail", 19 },         { HttpMethod::Get, "/api/preview", 20 },
+        { HttpMethod::Get, "/api/archive", 21 },           { HttpMethod::Post, "/api/extract", 22 },
+        { HttpMethod::Get, "/api/checksum", 23 },          { HttpMethod::Get, "/api/versions", 24 },
+        { HttpMethod::Post, "/api/versions/restore", 25 }, { HttpMethod::Get, "/api/shares", 26 },
+        { HttpMethod::Post, "/api/shares", 27 },           { HttpMethod::Delete, "/api/shares", 28 },
+        { HttpMethod::Get, "/api/links", 29 },             { HttpMethod::Post, "/api/links", 30 },
+        { HttpMethod::Delete, "/api/links", 31 },          { HttpMethod::Get, "/api/tags", 32 },
+        { HttpMethod::Post, "/api/tags", 33 },             { HttpMethod::Delete, "/api/tags", 34 },
+        { HttpMethod::Get, "/api/albums", 35 },            { HttpMethod::Post, "/api/albums", 36 },
+        { HttpMethod::Get, "/api/photos", 37 },            { HttpMethod::Get, "/api/photos/exif", 38 },
+        { HttpMethod::Get, "/api/videos", 39 },            { HttpMethod::Get, "/api/videos/stream", 40 },
+        { HttpMethod::Get, "/api/music", 41 },             { HttpMethod::Get, "/api/playlists", 42 },
+        { HttpMethod::Post, "/api/playlists", 43 },        { HttpMethod::Get, "/api/users", 44 },
+        { HttpMethod::Post, "/api/users", 45 },            { HttpMethod::Delete, "/api/users", 46 },
+        { HttpMethod::Get, "/api/users/me", 47 },          { HttpMethod::Put, "/api/users/me", 48 },
+        { HttpMethod::Post, "/api/login", 49 },            { HttpMethod::Post, "/api/logout", 50 },
+        { HttpMethod::Get, "/api/sessions", 51 },          { HttpMethod::Delete, "/api/sessions", 52 },
+        { HttpMethod::Get, "/api/quota", 53 },             { HttpMethod::Get, "/api/disks", 54 },
+        { HttpMethod::Get, "/api/backups", 55 },           { HttpMethod::Post, "/api/backups", 56 },
+        { HttpMethod::Post, "/api/backups/restore", 57 },  { HttpMethod::Get, "/api/logs", 58 },
+        { HttpMethod::Get, "/api/config", 59 },            { HttpMethod::Put, "/api/config", 60 },
+        { HttpMethod::Get, "/api/health", 61 },            { HttpMethod::Get, "/api/version", 62 },
+        { HttpMethod::Post, "/api/reboot", 63 },           { HttpMethod::Get, "/api/events", 64 },
+    };
+    constexpr RouteTable many_table(many_routes);
+
+    constexpr Route<Handler> few_routes[] = {
+        { HttpMethod::Get, "/api/files", 1 },   { HttpMethod::Get, "/api/download", 2 },
+        { HttpMethod::Post, "/api/upload", 3 }, { HttpMethod::Delete, "/api/delete", 4 },
+        { HttpMethod::Get, "/api/stats", 5 },   { HttpMethod::Get, "/api/metrics", 6 },
+    };
+    constexpr RouteTable few_table(few_routes);
+
+    const char* methodText(HttpMethod method) {
+        switch (method) {
+        case HttpMethod::Get: return "GET";
+        case HttpMethod::Head: return "HEAD";
+        case HttpMethod::Post: return "POST";
+        case HttpMethod::Put: return "PUT";
+        case HttpMethod::Delete: return "DELETE";
+        case HttpMethod::Options: return "OPTIONS";
+        default: return "";
+        }
+    }
+
+    // As the request arrived: method and path as text.
+    struct Request {
+        std::string method;
+        std::string path;
+    };
+
+    // handleApiRequest as it was, `request.path == "..." && request.method == "..."`
+    // for one route after another, spelled as a loop.
+    struct Chain {
+        std::vector<std::pair<const char*, const char*>> routes;    // Path, method
+
+        Handler find(const Request& request) const {
+            Handler handler = 0;
+            for (const auto& [path, method] : routes) {
+                ++handler;
+                if (request.path == path && request.method == method) {
+                    return handler;
+                }
+            }
+            return 0;
+        }
+    };
+
+    template <typename Table>
+    Handler dispatch(const Table& table, const Request& request) {
+        const Handler* handler = table.find(httpMethod(request.method), request.path);
+        return handler != nullptr ? *handler : 0;
+    }
+
+    template <typename Find>
+    double timeRequests(const std::vector<Request>& requests, Find&& find) {
+        return nsPerCall([&] {
+                   for (const Request& request : requests) {
+                       keep(find(request));
+                   }
+               }) /
+               static_cast<double>(requests.size());
+    }
+}
+
+int main() {
+    Chain chain;
+    for (const Route<Handler>& route : many_routes) {
+        chain.routes.emplace_back(route.path.data(), methodText(route.method));
+    }
+    auto request = [](const Route<Handler>& route) {
+        return Request{ methodText(route.method), std::string(route.path) };
+    };
+
+    std::vector<Request> all;
+    for (const Route<Handler>& route : many_routes) {
+        all.push_back(request(route));
+    }
+    struct Case {
+        const char* label;
+        std::vector<Request> requests;
+    };
+    const Case cases[] = {
+        { "first route", { request(many_routes[0]) } },
+        { "last route", { request(many_routes[std::size(many_routes) - 1]) } },
+        { "no such route", { Request{ "GET", "/api/nothing-here" } } },
+        { "each route in turn", all },
+    };
+
+    std::printf("%zu routes\n", std::size(many_routes));
+    for (const Case& c : cases) {
+        std::printf("%s\n", c.label);
+        double chain_ns = timeRequests(c.requests, [&](const Request& r) { return chain.find(r); });
+        report("string comparison chain", chain_ns);
+        report("RouteTable", timeRequests(c.requests, [&](const Request& r) { return dispatch(many_table, r); }),
+                chain_ns);
+    }
+
+    std::printf("the same lookup in a table of %zu routes and of %zu\n", std::size(few_routes), std::size(many_routes));
+    std::vector<Request> common;
+    for (const Route<Handler>& route : few_routes) {
+        common.push_back(request(route));
+    }
+    double few_ns = timeRequests(common, [&](const Request& r) { return dispatch(few_table, r); });
+    report("RouteTable, 6 routes", few_ns);
+    report("RouteTable, 64 routes", timeRequests(common, [&](const Request& r) { return dispatch(many_table, r); }),
+            few_ns);
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "Check.h"
+#include "Router.h"
+
+#include <string_view>
+
+namespace {
+    using Handler = int;
+
+    // The server's API table (Server::handleApiRequest), with ids in place of handlers, plus
+    // two routes that share a path with it under other methods
+    constexpr Route<Handler> api_routes[] = {
+        { HttpMethod::Get, "/api/files", 1 },
+        { HttpMethod::Get, "/api/download", 2 },
+        { HttpMethod::Post, "/api/upload", 3 },
+        { HttpMethod::Delete, "/api/delete", 4 },
+        { HttpMethod::Get, "/api/stats", 5 },
+        { HttpMethod::Get, "/api/metrics", 6 },
+        { HttpMethod::Head, "/api/files", 7 },
+        { HttpMethod::Options, "/api/files", 8 },
+    };
+    constexpr RouteTable api_table(api_routes);
+
+    // Lookups work at compile time too
+    static_assert(api_table.find(HttpMethod::Get, "/api/files") != nullptr);
+    static_assert(*api_table.find(HttpMethod::Post, "/api/upload") == 3);
+    static_assert(api_table.find(HttpMethod::Put, "/api/upload") == nullptr);
+
+    int lookup(std::string_view method, std::string_view path) {
+        const Handler* handler = api_table.find(httpMethod(method), path);
+        return handler != nullptr ? *handler : 0;
+    }
+
+    void testApiRoutes() {
+        for (const Route<Handler>& route : api_routes) {
+            CHECK(api_table.find(route.method, route.path) != nullptr);
+            CHECK(*api_table.find(route.method, route.path) == route.handler);
+        }
+
+        // Same path, different methods
+        CHECK(lookup("GET", "/api/files") == 1);
+        CHECK(lookup("HEAD", "/api/files") == 7);
+        CHECK(lookup("OPTIONS", "/api/files") == 8);
+        CHECK(lookup("DELETE", "/api/files") == 0);
+        CHECK(lookup("GET", "/api/delete") == 0);
+
+        // Exact, case-sensitive matches only
+        CHECK(lookup("GET", "/api/files/") == 0);
+        CHECK(lookup("GET", "/api/File") == 0);
+        CHECK(lookup("GET", "/API/files") == 0);
+        CHECK(lookup("get", "/api/files") == 0);
+        CHECK(lookup("GET", "") == 0);
+        CHECK(lookup("GET", "/api/stat") == 0);
+        CHECK(lookup("GET", "/api/statsx") == 0);
+        CHECK(lookup("BREW", "/api/stats") == 0);
+    }
+
+    // A bigger table still places every route in a slot of its own.
+    void testLargeTable() {
+        static constexpr Route<Handler> table_routes[] = {
+            { HttpMethod::Get, "/a", 1 }, { HttpMethod::Get, "/b", 2 }, { HttpMethod::Get, "/c", 3 },
+            { HttpMethod::Get, "/d", 4 }, { HttpMethod::Get, "/e", 5 }, { HttpMethod::Get, "/f", 6 },
+            { HttpMethod::Get, "/g", 7 }, { HttpMethod::Get, "/h", 8 }, { HttpMethod::Get, "/i", 9 },
+            { HttpMethod::Get, "/j", 10 }, { HttpMethod::Get, "/k", 11 }, { HttpMethod::Get, "/l", 12 },
+            { HttpMethod::Post, "/a", 101 }, { HttpMethod::Post, "/b", 102 }, { HttpMethod::Post, "/c", 103 },
+            { HttpMethod::Post, "/d", 104 }, { HttpMethod::Post, "/e", 105 }, { HttpMethod::Post, "/f", 106 },
+            { HttpMethod::Post, "/g", 107 }, { HttpMethod::Post, "/h", 108 }, { HttpMethod::Post, "/i", 109 },
+            { HttpMethod::Post, "/j", 110 }, { HttpMethod::Post, "/k", 111 }, { HttpMethod::Post, "/l", 112 },
+        };
+        static constexpr RouteTable table(table_routes);
+
+        for (const Route<Handler>& route : table_routes) {
+            const Handler* handler = table.find(route.method, route.path);
+            CHECK(handler != nullptr && *handler == route.handler);
+        }
+        CHECK(table.find(HttpMethod::Get, "/m") == nullptr);
+        CHECK(table.find(HttpMethod::Delete, "/a") == nullptr);
+    }
+
+    void testMethods() {
+        CHECK(httpMethod("GET") == HttpMethod::Get);
+        CHECK(httpMethod("HEAD") == HttpMethod::Head);
+        CHECK(httpMethod("POST") == HttpMethod::Post);
+        CHECK(httpMethod("PUT") == HttpMethod::Put);
+        CHECK(httpMethod("DELETE") == HttpMethod::Delete);
+        CHECK(httpMethod("OPTIONS") == HttpMethod::Options);
+        CHECK(httpMethod("PATCH") == HttpMethod::Other);
+        CHECK(httpMethod("") == HttpMethod::Other);
+    }
+}
+
+int main() {
+    testApiRoutes();
+    testLargeTable();
+    testMethods();
+    return checkFailures();
+}
@@ -0,0 +1,105 @@
+#include "Bench.h"
+#include "RequestCorpus.h"
+
+// Built in, as in HttpScanTest, so every kernel the CPU supports can be timed and not
+// only the one picked at startup.
+#include "HttpScan.cpp"
+#include "HttpRequest.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Header scanning throughput for each scan kernel over the header lines in
+// RequestCorpus.h, scanned the way HttpRequestParser does it, and then the whole
+// parser's throughput over the same requests.
+namespace {
+    using Finder = const char* (*)(const char*, const char*);
+
+    struct Variant {
+        const char* name;
+        Finder find_non_token;
+        Finder find_control;
+    };
+
+    std::vector<Variant> supportedVariants() {
+        std::vector<Variant> variants{ { "scalar", findNonTokenScalar, findControlScalar } };
+#ifdef HTTP_SCAN_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) {
+            variants.push_back({ "sse4.2", findNonTokenSse42, findControlSse42 });
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("sse4.2")) {
+            variants.push_back({ "avx2", findNonTokenAvx2, findControlAvx2 });
+        }
+#endif
+        return variants;
+    }
+
+    // Every header line of the corpus, without its CRLF.
+    std::vector<std::string_view> headerLines() {
+        std::vector<std::string_view> lines;
+        for (const std::string& text : requestCorpus()) {
+            std::string_view rest(text);
+            rest.remove_prefix(rest.find("\r\n") + 2);    // The request line
+            for (size_t end; (end = rest.find("\r\n")) != 0 && end != std::string_view::npos;) {
+                lines.push_back(rest.substr(0, end));
+                rest.remove_prefix(end + 2);
+            }
+        }
+        return lines;
+    }
+
+    // The name runs to the first non-token byte, the ':'; the value is checked for
+    // control bytes from there to the end of the line.
+    void scanHeaders(const Variant& variant, const std::vector<std::string_view>& lines) {
+        for (std::string_view line : lines) {
+            const char* end = line.data() + line.size();
+            const char* colon = variant.find_non_token(line.data(), end);
+            keep(variant.find_control(colon + 1, end));
+        }
+    }
+
+    void reportRate(const char* label, double ns, double bytes, double baseline_ns = 0) {
+        std::printf("  %-32s %8.1f ns %8.0f MB/s", label, ns, bytes / ns * 1e3);
+        if (baseline_ns > 0) {
+            std::printf("  %5.2fx", baseline_ns / ns);
+        }
+        std::printf("\n");
+    }
+}
+
+int main() {
+    std::vector<std::string_view> lines = headerLines();
+    double header_bytes = 0;
+    for (std::string_view line : lines) {
+        header_bytes += static_cast<double>(line.size());
+    }
+    std::printf("%zu header lines, %.0f bytes; %s picked at startup\n", lines.size(), header_bytes,
+            HttpScan::kernelName());
+
+    double scalar_ns = 0;
+    for (const Variant& variant : supportedVariants()) {
+        double ns = nsPerCall([&] { scanHeaders(variant, lines); });
+        scalar_ns = scalar_ns == 0 ? ns : scalar_ns;
+        std::string label = std::string(variant.name) + " scan";
+        reportRate(label.c_str(), ns, header_bytes, scalar_ns);
+    }
+
+    double request_bytes = 0;
+    for (const std::string& text : requestCorpus()) {
+        request_bytes += static_cast<double>(text.size());
+    }
+    HttpRequestParser parser(64 * 1024);
+    double parse_ns = nsPerCall([&] {
+        for (const std::string& text : requestCorpus()) {
+            HttpRequest request;
+            parser.parse(text);
+            parser.build(request, text);
+            parser.reset();
+            keep(request);
+        }
+    });
+    reportRate("HttpRequestParser, whole requests", parse_ns, request_bytes);
+    return 0;
+}
@@ -0,0 +1,572 @@
+#include "Check.h"
+#include "TestServer.h"
+
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+    // Downloads go out with sendfile() (or io_uring reads); a 0-byte file must give an
+    // empty 200 and leave the connection usable.
+    void testDownloads(TestServer& server) {
+        Client client(server.port());
+        Response data = client.request("GET", "/api/download?file=data.bin");
+        CHECK(data.status == 200);
+        CHECK(data.body == readFile(server.root / "data.bin"));
+        CHECK(data.header("content-length") == "200000");
+        CHECK(data.header("content-disposition") == "attachment; filename=\"data.bin\"");
+
+        Response empty = client.request("GET", "/api/download?file=empty.bin");
+        CHECK(empty.status == 200);
+        CHECK(empty.header("content-length") == "0");
+        CHECK(empty.body.empty());
+
+        Response after = client.request("GET", "/api/download?file=data.bin");
+        CHECK(after.status == 200);
+        CHECK(after.body.size() == 200000);
+
+        CHECK(client.request("GET", "/api/download?file=missing.bin").status == 404);
+        CHECK(client.request("GET", "/api/download?file=../server.log").status == 404);
+        CHECK(client.request("GET", "/api/download").status == 400);
+    }
+
+    // The parts of a multipart/byteranges body: each part's Content-Range and bytes.
+    std::vector<std::pair<std::string, std::string>> multipartParts(const Response& response) {
+        std::vector<std::pair<std::string, std::string>> parts;
+        std::string type = response.header("content-type");
+        std::string prefix = "multipart/byteranges; boundary=";
+        if (!type.starts_with(prefix)) {
+            return parts;
+        }
+        std::string delimiter = "\r\n--" + type.substr(prefix.size());
+        const std::string& body = response.body;
+
+        size_t at = body.find(delimiter);
+        while (at != std::string::npos && body.compare(at + delimiter.size(), 2, "--") != 0) {
+            size_t head_end = body.find("\r\n\r\n", at);
+            size_t next = body.find(delimiter, head_end);
+            if (head_end == std::string::npos || next == std::string::npos) {
+                return {};
+            }
+            std::string head = body.substr(at, head_end - at);
+            size_t range_at = head.find("Content-Range: ");
+            std::string range = range_at == std::string::npos ? "" : head.substr(range_at + 15, head.find("\r\n", range_at) - range_at - 15);
+            parts.emplace_back(range, body.substr(head_end + 4, next - head_end - 4));
+            at = next;
+        }
+        // Nothing but the closing delimiter after the last part
+        if (at == std::string::npos || body.substr(at) != delimiter + "--\r\n") {
+            return {};
+        }
+        return parts;
+    }
+
+    void testRanges(TestServer& server) {
+        std::string data = readFile(server.root / "data.bin");
+        Client client(server.port());
+
+        Response single = client.request("GET", "/api/download?file=data.bin", "Range: bytes=100-199\r\n");
+        CHECK(single.status == 206);
+        CHECK(single.header("content-range") == "bytes 100-199/200000");
+        CHECK(single.body == data.substr(100, 100));
+
+        Response suffix = client.request("GET", "/api/download?file=data.bin", "Range: bytes=-10\r\n");
+        CHECK(suffix.status == 206);
+        CHECK(suffix.body == data.substr(data.size() - 10));
+
+        // Resuming a download from the middle
+        Response resume = client.request("GET", "/api/download?file=data.bin", "Range: bytes=150000-\r\n");
+        CHECK(resume.status == 206);
+        CHECK(resume.body == data.substr(150000));
+
+        Response multi = client.request("GET", "/api/download?file=data.bin", "Range: bytes=0-9, 1000-1019, -5\r\n");
+        CHECK(multi.status == 206);
+        CHECK(std::to_string(multi.body.size()) == multi.header("content-length"));
+        auto parts = multipartParts(multi);
+        CHECK(parts.size() == 3);
+        if (parts.size() == 3) {
+            CHECK(parts[0].first == "bytes 0-9/200000");
+            CHECK(parts[0].second == data.substr(0, 10));
+            CHECK(parts[1].first == "bytes 1000-1019/200000");
+            CHECK(parts[1].second == data.substr(1000, 20));
+            CHECK(parts[2].first == "bytes 199995-199999/200000");
+            CHECK(parts[2].second == data.substr(199995));
+        }
+
+        // Overlapping ranges come back merged, as one
+        Response merged = client.request("GET", "/api/download?file=data.bin", "Range: bytes=0-99, 50-149\r\n");
+        CHECK(merged.status == 206);
+        CHECK(merged.header("content-range") == "bytes 0-149/200000");
+        CHECK(merged.body == data.substr(0, 150));
+
+        Response unsatisfiable = client.request("GET", "/api/download?file=data.bin", "Range: bytes=200000-\r\n");
+        CHECK(unsatisfiable.status == 416);
+        CHECK(unsatisfiable.header("content-range") == "bytes */200000");
+
+        // Nothing to satisfy in an empty file either
+        CHECK(client.request("GET", "/api/download?file=empty.bin", "Range: bytes=0-\r\n").status == 416);
+
+        // Syntax we don't understand: the whole file
+        Response ignored = client.request("GET", "/api/download?file=data.bin", "Range: lines=1-2\r\n");
+        CHECK(ignored.status == 200);
+        CHECK(ignored.body.size() == data.size());
+
+        // If-Range: the range only while the validator still holds
+        Response full = client.request("GET", "/api/download?file=data.bin");
+        std::string etag = full.header("etag");
+        std::string modified = full.header("last-modified");
+        CHECK(!etag.empty() && !modified.empty());
+
+        Response current = client.request("GET", "/api/download?file=data.bin",
+            "Range: bytes=0-9\r\nIf-Range: " + etag + "\r\n");
+        CHECK(current.status == 206);
+        CHECK(current.body == data.substr(0, 10));
+
+        Response by_date = client.request("GET", "/api/download?file=data.bin",
+            "Range: bytes=0-9\r\nIf-Range: " + modified + "\r\n");
+        CHECK(by_date.status == 206);
+
+        Response stale = client.request("GET", "/api/download?file=data.bin",
+            "Range: bytes=0-9\r\nIf-Range: \"not-the-etag\"\r\n");
+        CHECK(stale.status == 200);
+        CHECK(stale.body == data);
+
+        Response weak = client.request("GET", "/api/download?file=data.bin",
+            "Range: bytes=0-9\r\nIf-Range: W/" + etag + "\r\n");
+        CHECK(weak.status == 200);
+    }
+
+    // Static assets answer If-None-Match and If-Modified-Since with a bare 304, per
+    // representation: the gzip variant has a tag of its own.
+    void testStaticConditional(TestServer& server) {
+        std::string page = readFile(server.web / "index.html");
+        Client client(server.port());
+
+        Response identity = client.request("GET", "/index.html");
+        CHECK(identity.status == 200);
+        CHECK(identity.body == page);
+        std::string etag = identity.header("etag");
+        std::string modified = identity.header("last-modified");
+        CHECK(etag.starts_with('"') && etag.ends_with('"'));
+        CHECK(parseHttpDate(modified).has_value());
+        CHECK(identity.header("cache-control") == "no-cache");
+        CHECK(client.request("GET", "/").body == page);
+
+        Response by_tag = client.request("GET", "/index.html", "If-None-Match: " + etag + "\r\n");
+        CHECK(by_tag.status == 304);
+        CHECK(by_tag.header("etag") == etag);
+        CHECK(by_tag.header("content-length").empty() || by_tag.header("content-length") == "0");
+
+        CHECK(client.request("GET", "/index.html", "If-None-Match: \"other\", W/" + etag + "\r\n").status == 304);
+        CHECK(client.request("GET", "/index.html", "If-None-Match: *\r\n").status == 304);
+        CHECK(client.request("GET", "/index.html", "If-None-Match: \"other\"\r\n").status == 200);
+        CHECK(client.request("GET", "/index.html", "If-Modified-Since: " + modified + "\r\n").status == 304);
+        CHECK(client.request("GET", "/index.html", "If-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT\r\n").status == 200);
+        // If-None-Match wins over a date that would have matched
+        CHECK(client.request("GET", "/index.html",
+            "If-None-Match: \"other\"\r\nIf-Modified-Since: " + modified + "\r\n").status == 200);
+
+        // The identity tag doesn't validate the gzip variant, and the other way round
+        Response gzip = client.request("GET", "/index.html", "Accept-Encoding: gzip\r\n");
+        CHECK(gzip.status == 200);
+        CHECK(gzip.header("content-encoding") == "gzip");
+        std::string gzip_etag = gzip.header("etag");
+        CHECK(!gzip_etag.empty() && gzip_etag != etag);
+        CHECK(client.request("GET", "/index.html", "Accept-Encoding: gzip\r\nIf-None-Match: " + etag + "\r\n").status == 200);
+        CHECK(client.request("GET", "/index.html", "Accept-Encoding: gzip\r\nIf-None-Match: " + gzip_etag + "\r\n").status == 304);
+        CHECK(client.request("GET", "/index.html", "If-None-Match: " + gzip_etag + "\r\n").status == 200);
+
+        // Rewriting the file changes the validators
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        writeFile(server.web / "index.html", page + "<!-- edited -->\n");
+        Response edited = client.request("GET", "/index.html", "If-None-Match: " + etag + "\r\n");
+        CHECK(edited.status == 200);
+        CHECK(edited.header("etag") != etag);
+        CHECK(edited.body == page + "<!-- edited -->\n");
+        writeFile(server.web / "index.html", page);
+
+        CHECK(client.request("GET", "/missing.html").status == 404);
+        CHECK(client.request("GET", "/../files/data.bin").status == 404);
+    }
+
+    size_t countLines(const fs::path& log, const std::string& text) {
+        std::ifstream file(log);
+        size_t count = 0;
+        for (std::string line; std::getline(file, line);) {
+            count += line.find(text) != std::string::npos ? 1 : 0;
+        }
+        return count;
+    }
+
+    // Downloads and listings carry validators and answer a revalidation with 304,
+    // which costs no body and isn't logged as a download.
+    void testApiConditional(TestServer& server) {
+        Client client(server.port());
+        fs::path log = server.config.log_file;
+
+        Response download = client.request("GET", "/api/download?file=data.bin");
+        std::string etag = download.header("etag");
+        std::string modified = download.header("last-modified");
+        CHECK(download.status == 200);
+        CHECK(etag.starts_with('"'));
+        CHECK(parseHttpDate(modified).has_value());
+        size_t logged = countLines(log, "File downloaded: data.bin");
+        CHECK(logged > 0);
+
+        Response by_tag = client.request("GET", "/api/download?file=data.bin", "If-None-Match: " + etag + "\r\n");
+        CHECK(by_tag.status == 304);
+        CHECK(by_tag.header("etag") == etag);
+        CHECK(client.request("GET", "/api/download?file=data.bin", "If-Modified-Since: " + modified + "\r\n").status == 304);
+        CHECK(countLines(log, "File downloaded: data.bin") == logged);
+        CHECK(client.request("GET", "/api/download?file=data.bin", "If-None-Match: \"other\"\r\n").status == 200);
+        CHECK(countLines(log, "File downloaded: data.bin") == logged + 1);
+
+        // The connection carries on normally after a 304
+        CHECK(client.request("GET", "/api/download?file=empty.bin").status == 200);
+
+        Response listing = client.request("GET", "/api/files?path=docs");
+        std::string version = listing.header("etag");
+        CHECK(listing.status == 200);
+        CHECK(version.starts_with("W/\""));
+        CHECK(client.request("GET", "/api/files?path=docs", "If-None-Match: " + version + "\r\n").status == 304);
+
+        // The same directory as NDJSON is another representation
+        Response ndjson = client.request("GET", "/api/files?path=docs&format=ndjson");
+        CHECK(ndjson.header("etag") != version);
+        CHECK(client.request("GET", "/api/files?path=docs&format=ndjson", "If-None-Match: " + version + "\r\n").status == 200);
+
+        // A new entry changes the directory's version
+        writeFile(server.root / "docs" / "c.txt", "gamma");
+        Response changed = client.request("GET", "/api/files?path=docs", "If-None-Match: " + version + "\r\n");
+        CHECK(changed.status == 200);
+        CHECK(changed.header("etag") != version);
+        CHECK(changed.body.find("c.txt") != std::string::npos);
+        fs::remove(server.root / "docs" / "c.txt");
+    }
+
+    // Inflates a gzip or zlib stream; empty if it isn't one.
+    std::string inflateBody(const std::string& data, ContentCoding coding) {
+        z_stream stream{};
+        if (inflateInit2(&stream, coding == ContentCoding::Gzip ? 15 + 16 : 15) != Z_OK) {
+            return {};
+        }
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+        stream.avail_in = static_cast<uInt>(data.size());
+        std::string out;
+        int result = Z_OK;
+        while (result == Z_OK) {
+            char buffer[16384];
+            stream.next_out = reinterpret_cast<Bytef*>(buffer);
+            stream.avail_out = sizeof(buffer);
+            result = inflate(&stream, Z_NO_FLUSH);
+            out.append(buffer, sizeof(buffer) - stream.avail_out);
+        }
+        inflateEnd(&stream);
+        return result == Z_STREAM_END && stream.avail_in == 0 ? out : std::string();
+    }
+
+    void testCompression(TestServer& server) {
+        std::string page = readFile(server.web / "index.html");
+        Client client(server.port());
+
+        Response gzip = client.request("GET", "/index.html", "Accept-Encoding: br, gzip\r\n");
+        CHECK(gzip.status == 200);
+        CHECK(gzip.header("content-encoding") == "gzip");
+        CHECK(gzip.header("vary") == "Accept-Encoding");
+        CHECK(gzip.body.size() < page.size());
+        CHECK(inflateBody(gzip.body, ContentCoding::Gzip) == page);
+
+        // Identity when the client takes nothing we make, or rules gzip out
+        Response plain = client.request("GET", "/index.html", "Accept-Encoding: br\r\n");
+        CHECK(plain.header("content-encoding").empty());
+        CHECK(plain.header("vary") == "Accept-Encoding");
+        CHECK(plain.body == page);
+        CHECK(client.request("GET", "/index.html", "Accept-Encoding: gzip;q=0\r\n").body == page);
+
+        // Generated responses are compressed as they stream, with the coding negotiated
+        Response listing = client.request("GET", "/api/files?path=docs");
+        Response deflated = client.request("GET", "/api/files?path=docs", "Accept-Encoding: gzip;q=0, deflate\r\n");
+        CHECK(deflated.status == 200);
+        CHECK(deflated.header("content-encoding") == "deflate");
+        CHECK(deflated.header("transfer-encoding") == "chunked");
+        CHECK(inflateBody(deflated.body, ContentCoding::Deflate) == listing.body);
+        // ...and get a tag of their own
+        CHECK(deflated.header("etag") != listing.header("etag"));
+        CHECK(deflated.header("etag").starts_with("W/\""));
+
+        // A client revalidates the copy it holds: the compressed one's tag gets a 304
+        // as long as the listing is unchanged, and so does the identity tag
+        Response gzipped = client.request("GET", "/api/files?path=docs", "Accept-Encoding: gzip\r\n");
+        CHECK(gzipped.header("content-encoding") == "gzip");
+        Response unchanged = client.request("GET", "/api/files?path=docs",
+            "Accept-Encoding: gzip\r\nIf-None-Match: " + gzipped.header("etag") + "\r\n");
+        CHECK(unchanged.status == 304);
+        CHECK(unchanged.header("etag") == gzipped.header("etag"));
+        CHECK(client.request("GET", "/api/files?path=docs",
+            "Accept-Encoding: gzip\r\nIf-None-Match: " + listing.header("etag") + "\r\n").status == 304);
+        CHECK(client.request("GET", "/api/files?path=docs",
+            "Accept-Encoding: deflate\r\nIf-None-Match: " + deflated.header("etag") + "\r\n").status == 304);
+        // The tag of another coding than this request would get isn't current for it
+        CHECK(client.request("GET", "/api/files?path=docs",
+            "Accept-Encoding: deflate\r\nIf-None-Match: " + gzipped.header("etag") + "\r\n").status == 200);
+
+        // Likewise an asset compressed on the way out, deflate having no variant of its own
+        Response page_deflated = client.request("GET", "/index.html", "Accept-Encoding: deflate\r\n");
+        CHECK(page_deflated.header("content-encoding") == "deflate");
+        Response page_unchanged = client.request("GET", "/index.html",
+            "Accept-Encoding: deflate\r\nIf-None-Match: " + page_deflated.header("etag") + "\r\n");
+        CHECK(page_unchanged.status == 304);
+        CHECK(page_unchanged.header("etag") == page_deflated.header("etag"));
+
+        // Downloads and non-text types go out as they are
+        Response download = client.request("GET", "/api/download?file=docs/a.txt", "Accept-Encoding: gzip\r\n");
+        CHECK(download.header("content-encoding").empty());
+        CHECK(download.body == "alpha");
+        Response image = client.request("GET", "/photo.png", "Accept-Encoding: gzip\r\n");
+        CHECK(image.header("content-encoding").empty());
+        CHECK(image.body == readFile(server.web / "photo.png"));
+    }
+
+    // Sidecars are sent byte for byte, tagged after the sidecar; a stale one is
+    // passed over for gzip made from the asset, and a replaced one is picked up.
+    void testSidecars(TestServer& server) {
+        Client client(server.port());
+
+        Response gzip = client.request("GET", "/app.js", "Accept-Encoding: gzip\r\n");
+        CHECK(gzip.status == 200);
+        CHECK(gzip.header("content-encoding") == "gzip");
+        CHECK(gzip.header("content-type") == "application/javascript");
+        CHECK(gzip.body == readFile(server.web / "app.js.gz"));
+        CHECK(gzip.header("etag") == etagOf(server.web / "app.js.gz", "gz"));
+        CHECK(client.request("GET", "/app.js", "Accept-Encoding: gzip\r\nIf-None-Match: " + gzip.header("etag") + "\r\n").status == 304);
+
+        // zstd first when the client takes both
+        Response zstd = client.request("GET", "/app.js", "Accept-Encoding: gzip, zstd\r\n");
+        CHECK(zstd.header("content-encoding") == "zstd");
+        CHECK(zstd.body == readFile(server.web / "app.js.zst"));
+        CHECK(zstd.header("etag") == etagOf(server.web / "app.js.zst", "zst"));
+
+        Response identity = client.request("GET", "/app.js");
+        CHECK(identity.header("content-encoding").empty());
+        CHECK(identity.body == readFile(server.web / "app.js"));
+
+        // The sidecar sent as its own file is just a file
+        CHECK(client.request("GET", "/app.js.gz").body == readFile(server.web / "app.js.gz"));
+
+        Response stale = client.request("GET", "/style.css", "Accept-Encoding: gzip\r\n");
+        CHECK(stale.header("content-encoding") == "gzip");
+        CHECK(stale.header("etag") == etagOf(server.web / "style.css", "gz"));
+        CHECK(inflateBody(stale.body, ContentCoding::Gzip) == readFile(server.web / "style.css"));
+
+        // Regenerated without touching the asset
+        std::string script = readFile(server.web / "app.js");
+        writeFile(server.web / "app.js.gz", gzipFast(script + "// rebuilt\n"));
+        Response rebuilt = client.request("GET", "/app.js", "Accept-Encoding: gzip\r\n");
+        CHECK(rebuilt.body == readFile(server.web / "app.js.gz"));
+        CHECK(rebuilt.header("etag") != gzip.header("etag"));
+
+        // Removed: made from the asset again
+        fs::remove(server.web / "app.js.gz");
+        Response built = client.request("GET", "/app.js", "Accept-Encoding: gzip\r\n");
+        CHECK(built.header("content-encoding") == "gzip");
+        CHECK(inflateBody(built.body, ContentCoding::Gzip) == script);
+        CHECK(built.header("etag") == etagOf(server.web / "app.js", "gz"));
+    }
+
+    std::set<std::string> listedNames(const Json::Value& entries) {
+        std::set<std::string> names;
+        for (const Json::Value& entry : entries) {
+            names.insert(entry["name"].asString());
+        }
+        return names;
+    }
+
+    // Listings stream out chunked as the directory is read, a few hundred entries a
+    // chunk; HTTP/1.0 clients get the same body with a Content-Length.
+    void testListings(TestServer& server) {
+        Client client(server.port());
+        Json::CharReaderBuilder builder;
+        std::unique_ptr<Json::CharReader> reader(builder.newCharReader());
+        auto parse = [&](const std::string& text, Json::Value& value) {
+            return reader->parse(text.data(), text.data() + text.size(), &value, nullptr);
+        };
+
+        Response docs = client.request("GET", "/api/files?path=docs");
+        Json::Value value;
+        CHECK(docs.status == 200);
+        CHECK(docs.header("transfer-encoding") == "chunked");
+        CHECK(docs.header("content-length").empty());
+        CHECK(docs.header("content-type") == "application/json");
+        CHECK(parse(docs.body, value) && value.isArray());
+        CHECK(listedNames(value) == std::set<std::string>({ "a.txt", "b.txt" }));
+
+        Response many = client.request("GET", "/api/files?path=many");
+        CHECK(parse(many.body, value) && value.size() == 600);
+        CHECK(listedNames(value).count("file-599.txt") == 1);
+        CHECK(value[0]["path"].asString().starts_with("many/"));
+
+        Response ndjson = client.request("GET", "/api/files?path=many&format=ndjson");
+        CHECK(ndjson.header("content-type") == "application/x-ndjson");
+        size_t lines = 0;
+        std::istringstream stream(ndjson.body);
+        for (std::string line; std::getline(stream, line); ++lines) {
+            CHECK(parse(line, value) && value.isObject());
+        }
+        CHECK(lines == 600);
+
+        // Missing directories list as empty, and the connection carries on after a
+        // chunked body
+        CHECK(client.request("GET", "/api/files?path=nowhere").body == "[]");
+        CHECK(client.request("GET", "/api/download?file=docs/b.txt").body == "beta");
+
+        Client old_client(server.port());
+        old_client.send("GET /api/files?path=many HTTP/1.0\r\n\r\n");
+        Response old = old_client.receive();
+        CHECK(old.status == 200);
+        CHECK(old.header("transfer-encoding").empty());
+        CHECK(old.header("content-length") == std::to_string(old.body.size()));
+        CHECK(parse(old.body, value) && value.size() == 600);
+    }
+
+    // Cached assets past zerocopy_min_bytes go out with MSG_ZEROCOPY (SEND_ZC on
+    // io_uring); the bytes must arrive intact while several responses share the one
+    // buffer, pipelined between other kinds of body.
+    void testZeroCopy(TestServer& server) {
+        std::string image = readFile(server.web / "photo.png");
+        Client client(server.port());
+
+        std::string requests;
+        for (int i = 0; i < 4; ++i) {
+            requests += "GET /photo.png HTTP/1.1\r\nHost: test\r\n\r\n";
+            requests += "GET /api/download?file=docs/a.txt HTTP/1.1\r\nHost: test\r\n\r\n";
+        }
+        client.send(requests);
+        for (int i = 0; i < 4; ++i) {
+            Response shared = client.receive();
+            CHECK(shared.status == 200);
+            CHECK(shared.body == image);
+            CHECK(client.receive().body == "alpha");
+        }
+
+        // A second connection reading the same buffer at the same time
+        Client other(server.port());
+        client.send("GET /photo.png HTTP/1.1\r\nHost: test\r\n\r\n");
+        other.send("GET /photo.png HTTP/1.1\r\nHost: test\r\n\r\n");
+        CHECK(other.receive().body == image);
+        CHECK(client.receive().body == image);
+    }
+
+    // Many requests in one write, past max_pipeline_depth and mixing every kind of
+    // body: answered in order, each complete.
+    void testPipelining(TestServer& server) {
+        Client client(server.port());
+        std::string requests;
+        for (int i = 0; i < 40; ++i) {
+            std::string file = i % 2 == 0 ? "docs/a.txt" : "docs/b.txt";
+            requests += "GET /api/download?file=" + file + " HTTP/1.1\r\nHost: test\r\n\r\n";
+            requests += "GET /api/nothing-" + std::to_string(i) + " HTTP/1.1\r\nHost: test\r\n\r\n";
+            if (i % 10 == 0) {
+                requests += "GET /api/files?path=docs HTTP/1.1\r\nHost: test\r\n\r\n";
+                requests += "GET /index.html HTTP/1.1\r\nHost: test\r\n\r\n";
+            }
+        }
+        client.send(requests);
+
+        std::string page = readFile(server.web / "index.html");
+        for (int i = 0; i < 40; ++i) {
+            Response download = client.receive();
+            CHECK(download.body == (i % 2 == 0 ? "alpha" : "beta"));
+            CHECK(client.receive().status == 404);
+            if (i % 10 == 0) {
+                CHECK(client.receive().body.find("a.txt") != std::string::npos);
+                CHECK(client.receive().body == page);
+            }
+        }
+    }
+
+    // Requests may arrive a byte at a time, and connections stay open unless the
+    // client asks otherwise.
+    void testKeepAlive(TestServer& server) {
+        Client slow(server.port());
+        std::string request = "GET /api/download?file=docs/a.txt HTTP/1.1\r\nHost: test\r\n\r\n";
+        for (char c : request) {
+            slow.send(std::string_view(&c, 1));
+        }
+        CHECK(slow.receive().body == "alpha");
+        CHECK(slow.request("GET", "/api/download?file=docs/b.txt").body == "beta");
+
+        Client closing(server.port());
+        Response last = closing.request("GET", "/api/download?file=docs/a.txt", "Connection: close\r\n");
+        CHECK(last.status == 200);
+        CHECK(closing.closedByPeer());
+
+        Client old(server.port());
+        old.send("GET /api/download?file=docs/a.txt HTTP/1.0\r\n\r\n");
+        CHECK(old.receive().body == "alpha");
+        CHECK(old.closedByPeer());
+
+        Client old_kept(server.port());
+        old_kept.send("GET /api/download?file=docs/a.txt HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+        CHECK(old_kept.receive().body == "alpha");
+        old_kept.send("GET /api/download?file=docs/b.txt HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+        CHECK(old_kept.receive().body == "beta");
+
+        // A malformed request gets a 400 and the connection is closed
+        Client bad(server.port());
+        bad.send("GET / HTTP/1.1\r\nBad Header\r\n\r\n");
+        CHECK(bad.receive().status == 400);
+        CHECK(bad.closedByPeer());
+    }
+
+    // HEAD gets the headers GET would, and no body: anything more would be read as the
+    // next response on a kept-alive connection.
+    void testHead(TestServer& server) {
+        Client client(server.port());
+        Response page = client.request("HEAD", "/");
+        CHECK(page.status == 200);
+        CHECK(page.header("content-length") == std::to_string(fs::file_size(server.web / "index.html")));
+        CHECK(client.request("GET", "/api/download?file=docs/a.txt").body == "alpha");
+
+        Response file = client.request("HEAD", "/api/download?file=data.bin");
+        CHECK(file.status == 200);
+        CHECK(file.header("content-length") == "200000");
+        CHECK(client.request("GET", "/api/download?file=docs/b.txt").body == "beta");
+
+        // A streamed listing
+        Response listing = client.request("HEAD", "/api/files?path=many");
+        CHECK(listing.status == 200);
+        CHECK(client.request("GET", "/api/download?file=docs/a.txt").body == "alpha");
+
+        // Pipelined, with a compressed asset in between
+        Response full_script = client.request("GET", "/app.js", "Accept-Encoding: gzip\r\n");
+        client.send("HEAD /app.js HTTP/1.1\r\nHost: test\r\nAccept-Encoding: gzip\r\n\r\n"
+            "HEAD /photo.png HTTP/1.1\r\nHost: test\r\n\r\n"
+            "GET /api/download?file=docs/b.txt HTTP/1.1\r\nHost: test\r\n\r\n");
+        Response script = client.receive(true);
+        CHECK(script.status == 200);
+        CHECK(script.header("content-encoding") == "gzip");
+        CHECK(script.header("content-length") == std::to_string(full_script.body.size()));
+        CHECK(client.receive(true).header("content-length") == "300000");
+        CHECK(client.receive().body == "beta");
+    }
+}
+
+int main() {
+    for (const char* backend : { "epoll", "io_uring" }) {
+        std::printf("%s\n", backend);
+        TestServer server(backend);
+        testDownloads(server);
+        testRanges(server);
+        testStaticConditional(server);
+        testApiConditional(server);
+        testCompression(server);
+        testSidecars(server);
+        testListings(server);
+        testZeroCopy(server);
+        testPipelining(server);
+        testKeepAlive(server);
+        testHead(server);
+    }
+    return checkFailures();
+}
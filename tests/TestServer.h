@@ -0,0 +1,287 @@
+#pragma once
+
+// A real server on loopback for the end-to-end tests, and a client to talk to it.
+// Server.cpp is one translation unit with no header of its own, so the including test
+// compiles it in.
+#include "Server.cpp"
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+    struct Response {
+        int status = 0;     // 0: the connection closed or timed out first
+        std::map<std::string, std::string> headers;     // Names lower-cased
+        std::string body;
+
+        std::string header(const std::string& name) const {
+            auto it = headers.find(name);
+            return it != headers.end() ? it->second : std::string();
+        }
+    };
+
+    // One client connection, reading responses off it one at a time.
+    class Client {
+    public:
+        explicit Client(uint16_t port) {
+            fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = htons(port);
+            timeval timeout{ 5, 0 };
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            connected = connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+        }
+
+        ~Client() { ::close(fd); }
+
+        Client(const Client&) = delete;
+        Client& operator=(const Client&) = delete;
+
+        bool connected = false;
+
+        void send(std::string_view data) {
+            while (!data.empty()) {
+                ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+                if (n <= 0) {
+                    return;
+                }
+                data.remove_prefix(static_cast<size_t>(n));
+            }
+        }
+
+        // A body is read as Content-Length or chunked coding say; none for HEAD, 204
+        // and 304.
+        Response receive(bool head = false) {
+            Response response;
+            size_t header_end = 0;
+            while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                if (!fill()) {
+                    return response;
+                }
+            }
+            std::string head_text = buffer.substr(0, header_end + 2);
+            buffer.erase(0, header_end + 4);
+
+            size_t line_end = head_text.find("\r\n");
+            std::string status_line = head_text.substr(0, line_end);
+            if (!status_line.starts_with("HTTP/1.") || status_line.size() < 12) {
+                return response;
+            }
+            for (size_t at = line_end + 2; at < head_text.size();) {
+                size_t end = head_text.find("\r\n", at);
+                std::string line = head_text.substr(at, end - at);
+                at = end + 2;
+                size_t colon = line.find(':');
+                std::string name = line.substr(0, colon);
+                for (char& c : name) {
+                    c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+                }
+                size_t value_start = line.find_first_not_of(' ', colon + 1);
+                response.headers[name] = value_start == std::string::npos ? "" : line.substr(value_start);
+            }
+
+            int status = std::atoi(status_line.c_str() + 9);
+            if (head || status == 204 || status == 304) {
+                response.status = status;
+            }
+            else if (response.header("transfer-encoding") == "chunked") {
+                if (readChunked(response.body)) {
+                    response.status = status;
+                }
+            }
+            else {
+                size_t length = std::strtoull(response.header("content-length").c_str(), nullptr, 10);
+                if (take(length, response.body)) {
+                    response.status = status;
+                }
+            }
+            return response;
+        }
+
+        Response request(const std::string& method, const std::string& target, const std::string& headers = "") {
+            send(method + " " + target + " HTTP/1.1\r\nHost: test\r\n" + headers + "\r\n");
+            return receive(method == "HEAD");
+        }
+
+        // True once the server has closed its side.
+        bool closedByPeer() {
+            return buffer.empty() && !fill();
+        }
+
+    private:
+        int fd = -1;
+        std::string buffer;
+
+        bool fill() {
+            char data[65536];
+            ssize_t n = recv(fd, data, sizeof(data), 0);
+            if (n <= 0) {
+                return false;
+            }
+            buffer.append(data, static_cast<size_t>(n));
+            return true;
+        }
+
+        bool take(size_t size, std::string& out) {
+            while (buffer.size() < size) {
+                if (!fill()) {
+                    return false;
+                }
+            }
+            out.append(buffer, 0, size);
+            buffer.erase(0, size);
+            return true;
+        }
+
+        bool readChunked(std::string& out) {
+            while (true) {
+                size_t line_end = 0;
+                while ((line_end = buffer.find("\r\n")) == std::string::npos) {
+                    if (!fill()) {
+                        return false;
+                    }
+                }
+                size_t size = std::strtoull(buffer.c_str(), nullptr, 16);
+                buffer.erase(0, line_end + 2);
+                std::string chunk;
+                if (!take(size + 2, chunk) || !chunk.ends_with("\r\n")) {
+                    return false;
+                }
+                if (size == 0) {
+                    return true;
+                }
+                out.append(chunk, 0, size);
+            }
+        }
+    };
+
+    inline std::string readFile(const fs::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    inline void writeFile(const fs::path& path, std::string_view contents) {
+        fs::create_directories(path.parent_path());
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    // Level 1: not what the server would produce itself at its own level.
+    inline std::string gzipFast(std::string_view text) {
+        std::string out;
+        Deflater::acquire(ContentCoding::Gzip, 1)->compress(text.data(), text.size(), true, out);
+        return out;
+    }
+
+    inline std::string etagOf(const fs::path& path, std::string_view suffix = {}) {
+        struct stat st{};
+        stat(path.c_str(), &st);
+        return fileETag(st, suffix);
+    }
+
+    inline uint16_t freePort() {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(addr);
+        bind(fd, reinterpret_cast<sockaddr*>(&addr), length);
+        getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length);
+        ::close(fd);
+        return ntohs(addr.sin_port);
+    }
+
+    // A server on one worker, over a root and web directory of its own, for the life
+    // of the object.
+    class TestServer {
+    public:
+        fs::path directory;
+        fs::path root;
+        fs::path web;
+        Config config;
+
+        explicit TestServer(const char* backend, bool logging = true) {
+            char name[] = "/tmp/server-test-XXXXXX";
+            directory = mkdtemp(name);
+            root = directory / "files";
+            web = directory / "web";
+            populate();
+
+            config.port = freePort();
+            config.root_directory = root.string();
+            config.web_directory = web.string();
+            config.enable_logging = logging;
+            config.log_file = (directory / "server.log").string();
+            config.io_backend = backend;
+            config.worker_threads = 1;
+            config.handler_threads = 2;
+            config.zerocopy_min_bytes = 64 * 1024;
+            server = std::make_unique<Server>(config);
+            thread = std::thread([this] { server->start(); });
+
+            auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+            while (!Client(port()).connected && std::chrono::steady_clock::now() < deadline) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+
+        ~TestServer() {
+            server->stop();
+            thread.join();
+            fs::remove_all(directory);
+        }
+
+        uint16_t port() const { return static_cast<uint16_t>(config.port); }
+
+    private:
+        std::unique_ptr<Server> server;
+        std::thread thread;
+
+        void populate() {
+            std::string data(200000, '\0');
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = static_cast<char>(i * 7 % 251);
+            }
+            writeFile(root / "data.bin", data);
+            writeFile(root / "empty.bin", "");
+            writeFile(root / "docs" / "a.txt", "alpha");
+            writeFile(root / "docs" / "b.txt", "beta");
+            for (int i = 0; i < 600; ++i) {
+                writeFile(root / "many" / ("file-" + std::to_string(i) + ".txt"), std::to_string(i));
+            }
+            std::string page = "<html><body><ul>\n";
+            for (int i = 0; i < 200; ++i) {
+                page += "<li>entry " + std::to_string(i) + "</li>\n";
+            }
+            writeFile(web / "index.html", page + "</ul></body></html>\n");
+
+            // Incompressible, and past zerocopy_min_bytes
+            std::mt19937 random(1);
+            std::string image(300000, '\0');
+            for (char& c : image) {
+                c = static_cast<char>(random());
+            }
+            writeFile(web / "photo.png", image);
+
+            // app.js ships with up-to-date .gz and .zst sidecars; style.css with a .gz
+            // older than itself
+            std::string script;
+            for (int i = 0; i < 300; ++i) {
+                script += "console.log('line " + std::to_string(i) + "');\n";
+            }
+            writeFile(web / "app.js", script);
+            writeFile(web / "app.js.gz", gzipFast(script));
+            writeFile(web / "app.js.zst", "not really zstd, but served as it is");
+            writeFile(web / "style.css", std::string(4000, ' ') + "body { color: red; }\n");
+            writeFile(web / "style.css.gz", gzipFast("stale"));
+            timespec times[2] = { { 0, UTIME_OMIT }, { 1000000000, 0 } };
+            utimensat(AT_FDCWD, (web / "style.css.gz").c_str(), times, 0);
+        }
+    };
+}
@@ -0,0 +1,146 @@
+#include "Net/IoBackend.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// CPU the sending thread spends per GB of 1 MB and larger in-memory bodies, sent with
+// send() and with sendZeroCopy(), on both backends. Over loopback the kernel copies
+// zero-copy sends anyway and the backends go back to plain sends, so the numbers that
+// matter come from a real NIC: run with --remote and point a sink at each run, e.g.
+//     nc <this host> <port> > /dev/null
+namespace {
+    constexpr size_t TotalBytes = size_t{ 1 } << 30;
+
+    // Accepts one connection and queues the whole run on it at once.
+    class Sender : public IoAcceptor, public IoChannel {
+    public:
+        IoBackend& backend;
+        std::shared_ptr<const std::vector<char>> body;
+        bool zero_copy;
+        int fd = -1;
+        bool completed = false;
+
+        Sender(IoBackend& io, std::shared_ptr<const std::vector<char>> data, bool zerocopy)
+                : backend(io), body(std::move(data)), zero_copy(zerocopy) {}
+
+        IoChannel* onAccept(int client, std::string) override {
+            fd = client;
+            backend.post([this] {
+                for (size_t queued = 0; queued < TotalBytes; queued += body->size()) {
+                    if (zero_copy) {
+                        backend.sendZeroCopy(fd, body->data(), body->size(), body);
+                    }
+                    else {
+                        backend.send(fd, body->data(), body->size());
+                    }
+                }
+            });
+            return this;
+        }
+
+        void onReceive(const char*, size_t) override {}
+        void onEndOfStream() override {}
+        void onSendProgress() override {}
+        void onError(int) override { backend.stop(); }
+
+        void onSendComplete() override {
+            completed = true;
+            backend.stop();
+        }
+    };
+
+    int listenOn(uint32_t address, uint16_t& port) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(address);
+        socklen_t length = sizeof(addr);
+        if (fd < 0 || bind(fd, reinterpret_cast<sockaddr*>(&addr), length) != 0 || ::listen(fd, 8) != 0 ||
+                getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &length) != 0) {
+            std::perror("listen");
+            std::exit(1);
+        }
+        port = ntohs(addr.sin_port);
+        return fd;
+    }
+
+    // Reads and drops everything, as a client downloading to disk would.
+    void sink(uint16_t port) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) {
+            static char buffer[1 << 20];
+            while (recv(fd, buffer, sizeof(buffer), 0) > 0) {
+            }
+        }
+        ::close(fd);
+    }
+
+    double threadCpuSeconds() {
+        timespec now{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        return static_cast<double>(now.tv_sec) + static_cast<double>(now.tv_nsec) / 1e9;
+    }
+
+    // CPU seconds per GB on the backend's thread; negative if the run failed.
+    double cpuPerGigabyte(const char* backend_name, size_t body_size, bool zero_copy, bool remote) {
+        std::string fallback;
+        std::unique_ptr<IoBackend> backend = createIoBackend(backend_name, fallback);
+        auto body = std::make_shared<const std::vector<char>>(body_size, 'x');
+        Sender sender(*backend, body, zero_copy);
+
+        uint16_t port = 0;
+        int listen_fd = listenOn(remote ? INADDR_ANY : INADDR_LOOPBACK, port);
+        backend->listen(listen_fd, false, &sender);
+        std::thread client;
+        if (remote) {
+            std::printf("    waiting for a sink on port %u\n", port);
+            std::fflush(stdout);
+        }
+        else {
+            client = std::thread([port] { sink(port); });
+        }
+
+        double started = threadCpuSeconds();
+        backend->run();
+        double cpu = threadCpuSeconds() - started;
+
+        backend->stopListening();
+        if (sender.fd >= 0) {
+            backend->close(sender.fd);
+        }
+        ::close(listen_fd);
+        if (client.joinable()) {
+            client.join();
+        }
+        return sender.completed ? cpu / (static_cast<double>(TotalBytes) / 1e9) : -1;
+    }
+}
+
+int main(int argc, char** argv) {
+    bool remote = argc > 1 && std::strcmp(argv[1], "--remote") == 0;
+    for (const char* backend : { "epoll", "io_uring" }) {
+        for (size_t megabytes : { 1, 4, 16 }) {
+            std::printf("%s, %zu MB bodies, 1 GB in all\n", backend, megabytes);
+            double copied = cpuPerGigabyte(backend, megabytes << 20, false, remote);
+            double zero_copy = cpuPerGigabyte(backend, megabytes << 20, true, remote);
+            std::printf("  %-44s %8.3f CPU s/GB\n", "send()", copied);
+            std::printf("  %-44s %8.3f CPU s/GB  %5.2fx\n", "sendZeroCopy()", zero_copy, copied / zero_copy);
+        }
+    }
+    return 0;
+}
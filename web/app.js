@@ -125,22 +125,57 @@
     async loadFiles(path = '') {
         try {
             this.showLoading();
-            const response = await fetch(`/api/files?path=${encodeURIComponent(path)}`);
-            
+            const response = await fetch(`/api/files?path=${encodeURIComponent(path)}&format=ndjson`);
+
             if (!response.ok) {
                 throw new Error(`HTTP ${response.status}: ${response.statusText}`);
             }
-            
-            const files = await response.json();
+
             this.currentPath = path;
-            this.displayFiles(files);
             this.updateBreadcrumb(path);
+
+            // Entries are shown as they arrive, then sorted once the listing is complete
+            const fileList = document.getElementById('fileList');
+            const files = [];
+            for await (const batch of this.readNdjson(response)) {
+                if (files.length === 0) {
+                    fileList.innerHTML = '';
+                }
+                files.push(...batch);
+                fileList.insertAdjacentHTML('beforeend', batch.map(file => this.createFileItem(file)).join(''));
+            }
+            this.displayFiles(files);
         } catch (error) {
             console.error('Failed to load files:', error);
             this.showError('Failed to load files: ' + error.message);
         }
     }
 
+    // Yields the objects of an NDJSON response a network read at a time.
+    async *readNdjson(response) {
+        const reader = response.body.getReader();
+        const decoder = new TextDecoder();
+        let pending = '';
+
+        while (true) {
+            const { done, value } = await reader.read();
+            if (done) break;
+
+            pending += decoder.decode(value, { stream: true });
+            const lines = pending.split('\n');
+            pending = lines.pop();
+            const batch = lines.filter(line => line.trim()).map(line => JSON.parse(line));
+            if (batch.length > 0) {
+                yield batch;
+            }
+        }
+
+        pending += decoder.decode();
+        if (pending.trim()) {
+            yield [JSON.parse(pending)];
+        }
+    }
+
     displayFiles(files) {
         const fileList = document.getElementById('fileList');
         